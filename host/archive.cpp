@@ -0,0 +1,169 @@
+#include "archive.h"
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+bool createArchive(ArchiveWriter &writer, const char *path) {
+  snprintf(writer.indexPath, sizeof(writer.indexPath), "%s.index", path);
+  writer.file = fopen(path, "wb");
+  writer.index = fopen(writer.indexPath, "w+b");
+  if (!writer.file || !writer.index) return false;
+
+  ArchiveHeader &header = writer.header;
+  header = ArchiveHeader();
+  memcpy(header.magic, archiveMagic, sizeof(header.magic));
+  header.version = archiveVersion;
+  header.headerSize = sizeof(header);
+  header.created = time(nullptr);
+  writer.offset = sizeof(header);
+  writer.count = 0;
+  return fwrite(&header, sizeof(header), 1, writer.file) == 1;
+}
+
+bool appendRecord(ArchiveWriter &writer, const MessageHeader &header, const uint8_t *payload, uint64_t hostTime) {
+  RecordHeader record = {};
+  record.length = header.length;
+  record.type = header.type;
+  record.flags = header.flags;
+  record.seq = header.seq;
+  record.timestamp = header.timestamp;
+  record.hostTime = hostTime;
+
+  static const uint8_t padding[8] = {};
+  uint32_t pad = recordSize(header.length) - sizeof(record) - header.length;
+  if (fwrite(&record, sizeof(record), 1, writer.file) != 1 ||
+      fwrite(payload, 1, header.length, writer.file) != header.length ||
+      fwrite(padding, 1, pad, writer.file) != pad) {
+    return false;
+  }
+
+  IndexEntry entry = {};
+  entry.offset = writer.offset;
+  entry.timestamp = header.timestamp;
+  entry.type = header.type;
+  if (fwrite(&entry, sizeof(entry), 1, writer.index) != 1) return false;
+
+  writer.offset += recordSize(header.length);
+  writer.count++;
+  return true;
+}
+
+// Index copied behind the records, then the header points at it
+bool finishArchive(ArchiveWriter &writer) {
+  bool ok = writer.file && writer.index;
+  if (ok) {
+    rewind(writer.index);
+    char buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), writer.index)) > 0) {
+      ok = ok && fwrite(buffer, 1, n, writer.file) == n;
+    }
+
+    ArchiveHeader header = writer.header;
+    header.indexOffset = writer.offset;
+    header.recordCount = writer.count;
+    ok = ok && fseek(writer.file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, writer.file) == 1;
+  }
+
+  if (writer.file) ok = fclose(writer.file) == 0 && ok;
+  if (writer.index) {
+    fclose(writer.index);
+    remove(writer.indexPath);
+  }
+  writer.file = writer.index = nullptr;
+  return ok;
+}
+
+static void rebuildIndex(Archive &archive) {
+  uint64_t offset = archive.header->headerSize;
+  while (offset + sizeof(RecordHeader) <= archive.size) {
+    const RecordHeader *record = (const RecordHeader *)(archive.data + offset);
+    if (offset + recordSize(record->length) > archive.size) break; // Torn last record
+    IndexEntry entry = {};
+    entry.offset = offset;
+    entry.timestamp = record->timestamp;
+    entry.type = record->type;
+    archive.rebuilt.push_back(entry);
+    offset += recordSize(record->length);
+  }
+  archive.index = archive.rebuilt.data();
+  archive.count = archive.rebuilt.size();
+}
+
+bool openArchive(Archive &archive, const char *path) {
+  archive.fd = open(path, O_RDONLY);
+  if (archive.fd < 0) return false;
+  struct stat info;
+  if (fstat(archive.fd, &info) != 0 || (size_t)info.st_size < sizeof(ArchiveHeader)) {
+    closeArchive(archive);
+    return false;
+  }
+  archive.size = info.st_size;
+  void *map = mmap(nullptr, archive.size, PROT_READ, MAP_SHARED, archive.fd, 0);
+  if (map == MAP_FAILED) {
+    closeArchive(archive);
+    return false;
+  }
+  archive.data = (const uint8_t *)map;
+  archive.header = (const ArchiveHeader *)archive.data;
+  if (memcmp(archive.header->magic, archiveMagic, sizeof(archiveMagic)) != 0 ||
+      archive.header->version != archiveVersion) {
+    closeArchive(archive);
+    return false;
+  }
+
+  const ArchiveHeader &h = *archive.header;
+  if (h.indexOffset && h.indexOffset + h.recordCount * sizeof(IndexEntry) <= archive.size) {
+    archive.index = (const IndexEntry *)(archive.data + h.indexOffset);
+    archive.count = h.recordCount;
+    archive.finished = true;
+  } else {
+    rebuildIndex(archive);
+  }
+  return true;
+}
+
+void closeArchive(Archive &archive) {
+  if (archive.data) munmap((void *)archive.data, archive.size);
+  if (archive.fd >= 0) close(archive.fd);
+  archive = Archive();
+}
+
+const RecordHeader *archiveRecord(const Archive &archive, uint64_t i, const uint8_t **payload) {
+  if (i >= archive.count) return nullptr;
+  const RecordHeader *record = (const RecordHeader *)(archive.data + archive.index[i].offset);
+  if (payload) *payload = (const uint8_t *)(record + 1);
+  return record;
+}
+
+bool nextArchiveFrame(const Archive &archive, ArchiveFrames &frames, uint16_t *pixels, uint32_t &timestamp) {
+  constexpr int pixelCount = archiveFrameWidth * archiveFrameHeight;
+  while (frames.next < archive.count) {
+    const uint8_t *payload;
+    const RecordHeader *record = archiveRecord(archive, frames.next++, &payload);
+    if (record->length < 4 || get16(payload) != archiveFrameWidth || get16(payload + 2) != archiveFrameHeight) continue;
+
+    if (record->type == MSG_RAW_FRAME && record->length == 4 + pixelCount * 2) {
+      for (int i = 0; i < pixelCount; i++) pixels[i] = get16(payload + 4 + i * 2);
+    } else if (record->type == MSG_DELTA_FRAME) {
+      if (record->flags & DELTA_KEYFRAME) {
+        memset(frames.reference, 0, sizeof(frames.reference));
+        frames.referenceValid = true;
+      }
+      if (!frames.referenceValid) continue;
+      if (!decodeDeltaFrame(payload + 4, record->length - 4, frames.reference, archiveFrameWidth, archiveFrameHeight)) {
+        frames.referenceValid = false; // Wait for the next keyframe
+        continue;
+      }
+      memcpy(pixels, frames.reference, sizeof(frames.reference));
+    } else {
+      continue;
+    }
+    timestamp = record->timestamp;
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#include "protocol.h"
+
+// Recording of the device stream, one record per verified message. Layout:
+//   ArchiveHeader
+//   records: RecordHeader, payload, zero padding to 8 bytes
+//   index: IndexEntry per record (written by finishArchive())
+// The header's indexOffset stays 0 until the archive is finished, so a crashed
+// recording is still readable, openArchive() rebuilds the index by scanning.
+// Host byte order (little-endian everywhere we run), structs are written as is.
+constexpr char archiveMagic[8] = { 'E', 'B', 'M', 'V', 'A', 'R', 'C', '1' };
+constexpr uint32_t archiveVersion = 1;
+
+struct ArchiveHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t headerSize;   // sizeof(ArchiveHeader), records start here
+  uint64_t created;      // Unix time (s)
+  uint64_t indexOffset;  // 0 = unfinished
+  uint64_t recordCount;  // Valid with indexOffset
+  uint8_t reserved[24];
+};
+static_assert(sizeof(ArchiveHeader) == 64, "archive header layout");
+
+struct RecordHeader {
+  uint32_t length;    // Payload bytes, not including padding
+  uint8_t type;       // MessageType
+  uint8_t flags;
+  uint16_t seq;
+  uint32_t timestamp; // Device micros()
+  uint32_t reserved;
+  uint64_t hostTime;  // CLOCK_REALTIME ns on arrival
+};
+static_assert(sizeof(RecordHeader) == 24, "record header layout");
+
+struct IndexEntry {
+  uint64_t offset;    // Of the RecordHeader
+  uint32_t timestamp;
+  uint8_t type;
+  uint8_t reserved[3];
+};
+static_assert(sizeof(IndexEntry) == 16, "index entry layout");
+
+inline uint64_t recordSize(uint32_t length) {
+  return sizeof(RecordHeader) + ((length + 7) & ~7u);
+}
+
+// Append-only writer. The index goes to a side file while recording so memory
+// stays flat however long the capture runs, and is copied in at the end.
+struct ArchiveWriter {
+  FILE *file = nullptr;
+  FILE *index = nullptr;
+  char indexPath[4096];
+  ArchiveHeader header;
+  uint64_t offset = 0;
+  uint64_t count = 0;
+};
+
+bool createArchive(ArchiveWriter &writer, const char *path);
+bool appendRecord(ArchiveWriter &writer, const MessageHeader &header, const uint8_t *payload, uint64_t hostTime);
+bool finishArchive(ArchiveWriter &writer);
+
+// Read side, the whole file is mapped
+struct Archive {
+  int fd = -1;
+  const uint8_t *data = nullptr;
+  size_t size = 0;
+  const ArchiveHeader *header = nullptr;
+  const IndexEntry *index = nullptr;
+  uint64_t count = 0;
+  bool finished = false;            // Index from the file, not rebuilt
+  std::vector<IndexEntry> rebuilt;  // Unfinished archives only
+};
+
+bool openArchive(Archive &archive, const char *path);
+void closeArchive(Archive &archive);
+// Record i and its payload, null if out of range
+const RecordHeader *archiveRecord(const Archive &archive, uint64_t i, const uint8_t **payload);
+
+// Camera frames in record order: MSG_RAW_FRAME records and the MSG_DELTA_FRAME
+// stream decoded against its keyframes. Other sizes are skipped.
+constexpr int archiveFrameWidth = 160, archiveFrameHeight = 120;
+struct ArchiveFrames {
+  uint64_t next = 0;  // Record to look at
+  uint16_t reference[archiveFrameWidth * archiveFrameHeight]; // Delta stream state
+  bool referenceValid = false;
+};
+
+// Next frame and its device timestamp, false at the end of the archive
+bool nextArchiveFrame(const Archive &archive, ArchiveFrames &frames, uint16_t *pixels, uint32_t &timestamp);
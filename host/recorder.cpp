@@ -0,0 +1,129 @@
+// Records the device stream to an archive (archive.h) for offline analysis.
+//
+//   g++ -O2 -std=c++17 -Isrc -Ihost host/recorder.cpp host/archive.cpp src/protocol.cpp -o recorder
+//   ./recorder /dev/ttyACM0 capture.ebmv    record until Ctrl-C
+//   ./recorder capture.raw capture.ebmv     a dump or pipe works too (ends at EOF)
+//   ./recorder --info capture.ebmv          summary of an archive
+//
+// Every message with a valid CRC is stored whatever its type, so new message
+// types are recorded without changes here.
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "archive.h"
+#include "protocol.h"
+
+static volatile sig_atomic_t stopping = 0;
+
+static void onSignal(int) {
+  stopping = 1;
+}
+
+static uint64_t hostNanos() {
+  timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+// Teensy USB serial ignores the baud rate, but a real UART or pty needs raw mode
+static bool configurePort(int fd) {
+  if (!isatty(fd)) return true;
+  termios options;
+  if (tcgetattr(fd, &options) != 0) return false;
+  cfmakeraw(&options);
+  cfsetspeed(&options, B921600);
+  options.c_cc[VMIN] = 1;
+  options.c_cc[VTIME] = 0;
+  return tcsetattr(fd, TCSANOW, &options) == 0;
+}
+
+static int info(const char *path) {
+  Archive archive;
+  if (!openArchive(archive, path)) {
+    fprintf(stderr, "Can't open archive %s\n", path);
+    return 1;
+  }
+
+  uint64_t perType[256] = {};
+  uint64_t bytes = 0;
+  for (uint64_t i = 0; i < archive.count; i++) {
+    const RecordHeader *record = archiveRecord(archive, i, nullptr);
+    perType[record->type]++;
+    bytes += record->length;
+  }
+  printf("%s: %llu records, %llu payload bytes%s\n", path, (unsigned long long)archive.count,
+         (unsigned long long)bytes, archive.finished ? "" : " (unfinished, index rebuilt)");
+  for (int type = 0; type < 256; type++) {
+    if (perType[type]) printf("  type %3d: %llu\n", type, (unsigned long long)perType[type]);
+  }
+  if (archive.count > 1) {
+    const RecordHeader *first = archiveRecord(archive, 0, nullptr);
+    const RecordHeader *last = archiveRecord(archive, archive.count - 1, nullptr);
+    printf("  duration %.3f s (host clock)\n", (last->hostTime - first->hostTime) * 1e-9);
+  }
+  closeArchive(archive);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc == 3 && strcmp(argv[1], "--info") == 0) return info(argv[2]);
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <port or file> <archive>\n       %s --info <archive>\n", argv[0], argv[0]);
+    return 1;
+  }
+
+  int fd = open(argv[1], O_RDONLY | O_NOCTTY);
+  if (fd < 0 || !configurePort(fd)) {
+    fprintf(stderr, "Can't open %s\n", argv[1]);
+    return 1;
+  }
+  ArchiveWriter writer;
+  if (!createArchive(writer, argv[2])) {
+    fprintf(stderr, "Can't create %s\n", argv[2]);
+    return 1;
+  }
+  setvbuf(writer.file, nullptr, _IOFBF, 1 << 20);
+
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+
+  // Memory is the parser's payload buffer plus one read chunk, however long we run
+  std::vector<uint8_t> payload(maxPayloadSize);
+  StreamParser parser;
+  initParser(parser, payload.data(), payload.size());
+  uint8_t chunk[65536];
+  uint64_t received = 0;
+  uint64_t lastReport = hostNanos();
+  bool ok = true;
+
+  while (!stopping && ok) {
+    ssize_t n = read(fd, chunk, sizeof(chunk));
+    if (n <= 0) break; // EOF, or interrupted by the signal
+    uint64_t arrival = hostNanos();
+    received += n;
+
+    size_t offset = 0;
+    while (offset < (size_t)n && ok) {
+      bool complete;
+      offset += parseStream(parser, chunk + offset, n - offset, complete);
+      if (complete) ok = appendRecord(writer, parser.current, payload.data(), arrival);
+    }
+
+    if (arrival - lastReport > 1000000000ull) {
+      fprintf(stderr, "\r%llu messages, %.1f MB, %u CRC errors, %u bytes skipped   ",
+              (unsigned long long)writer.count, received / 1e6, parser.crcErrors, parser.skippedBytes);
+      lastReport = arrival;
+    }
+  }
+  close(fd);
+
+  if (!ok) fprintf(stderr, "\nWrite failed, archive truncated\n");
+  ok = finishArchive(writer) && ok;
+  fprintf(stderr, "\n%llu messages recorded to %s\n", (unsigned long long)writer.count, argv[2]);
+  return ok ? 0 : 1;
+}
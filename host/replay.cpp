@@ -0,0 +1,123 @@
+// Replays recorded frames through the firmware pipeline on a workstation.
+// src/main.cpp is built unchanged against host/shim, which serves the frames
+// through the ArduCAM/SPI calls and runs the servo timer off a simulated clock.
+//
+//   g++ -O2 -std=gnu++17 -Ihost/shim -Isrc -Ihost src/*.cpp host/shim/shim.cpp host/shim/replayCamera.cpp host/archive.cpp host/replay.cpp -o replay
+//   ./replay capture.ebmv > run.csv           one line per frame
+//   ./replay capture.ebmv --no-timing         outputs only, identical every run (diff two builds)
+//
+// Frames are the MSG_RAW_FRAME and MSG_DELTA_FRAME records of an archive from
+// host/recorder. Output comes from the MSG_BLOBS records the firmware emits,
+// host processing time per frame (readout to next capture) is appended.
+// The replay is open loop: servo commands don't move the recorded camera, so
+// compare runs against each other rather than against the rig.
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+#include "archive.h"
+#include "protocol.h"
+#include "telemetry.h"
+#include "camera.h"
+#include "replayHardware.h"
+
+void setup();
+void loop();
+
+static Archive archive;
+static ArchiveFrames archiveFrames;
+static uint64_t frameLimit = 0;
+static uint64_t framesServed = 0;
+
+static bool nextFrame(uint16_t *pixels, uint32_t &timestamp) {
+  if (frameLimit && framesServed >= frameLimit) return false;
+  if (!nextArchiveFrame(archive, archiveFrames, pixels, timestamp)) return false;
+  framesServed++;
+  return true;
+}
+
+static StreamParser parser;
+static uint8_t parserPayload[4096];
+static std::map<uint32_t, uint64_t> hostMicros; // By frame number
+static std::vector<uint64_t> processing;
+static bool showTiming = true;
+
+static void printRecord(const FrameRecord &r) {
+  printf("%u,%u,%u,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,", r.frame, r.captureStart, r.blobCount, r.targetX,
+         r.targetY, r.azimuth, r.elevation, r.velAzimuth, r.velElevation, r.panCommand, r.tiltCommand, r.panActual,
+         r.tiltActual);
+  for (int i = 0; i < r.listed; i++) {
+    const BlobSummary &b = r.blobs[i];
+    printf("%s%.1f:%.1f:%u", i ? ";" : "", b.centreX, b.centreY, b.pixelCount);
+  }
+  if (showTiming) {
+    auto t = hostMicros.find(r.frame);
+    printf(",%llu", t != hostMicros.end() ? (unsigned long long)t->second : 0ull);
+  }
+  printf("\n");
+}
+
+// Firmware telemetry -> one CSV line per MSG_BLOBS
+static void drainOutput() {
+  serviceTelemetry();
+  for (const FrameHostTiming &t : takeHostTiming()) {
+    uint64_t micros = t.processEnd > t.readoutStart ? (t.processEnd - t.readoutStart) / 1000 : 0;
+    hostMicros[t.frame] = micros;
+    processing.push_back(micros);
+  }
+
+  std::vector<uint8_t> output = takeSerialOutput();
+  size_t offset = 0;
+  while (offset < output.size()) {
+    bool complete;
+    offset += parseStream(parser, output.data() + offset, output.size() - offset, complete);
+    if (!complete || parser.current.type != MSG_BLOBS) continue;
+    FrameRecord record;
+    if (decodeFrameRecord(parserPayload, parser.current.length, record)) printRecord(record);
+  }
+}
+
+int main(int argc, char **argv) {
+  const char *path = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--no-timing") == 0) showTiming = false;
+    else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) frameLimit = strtoull(argv[++i], nullptr, 10);
+    else path = argv[i];
+  }
+  if (!path || !openArchive(archive, path)) {
+    fprintf(stderr, "usage: %s <archive> [--no-timing] [--frames N]\n", argv[0]);
+    return 1;
+  }
+
+  initParser(parser, parserPayload, sizeof(parserPayload));
+  setFrameSource(nextFrame);
+  printf("frame,captureStart,blobs,targetX,targetY,azimuth,elevation,velAzimuth,velElevation,"
+         "panCommand,tiltCommand,panActual,tiltActual,blobList%s\n", showTiming ? ",hostMicros" : "");
+
+  setup();
+  blobsOut = 1; // The output below
+  for (;;) {
+    try {
+      loop();
+    } catch (const ReplayFinished &) {
+      endReplayFrame();
+      drainOutput();
+      break;
+    }
+    endReplayFrame();
+    drainOutput();
+  }
+
+  if (!processing.empty()) {
+    std::sort(processing.begin(), processing.end());
+    uint64_t total = 0;
+    for (uint64_t p : processing) total += p;
+    double mean = (double)total / processing.size();
+    fprintf(stderr, "%zu frames, host us/frame mean %.1f median %llu p99 %llu (%.0f fps)\n", processing.size(), mean,
+            (unsigned long long)processing[processing.size() / 2],
+            (unsigned long long)processing[processing.size() * 99 / 100], mean > 0 ? 1e6 / mean : 0.0);
+  }
+  closeArchive(archive);
+  return 0;
+}
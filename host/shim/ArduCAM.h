@@ -0,0 +1,30 @@
+#pragma once
+#include <Arduino.h>
+
+// Stand-in for the FIFO side of lib/ArduCAM that src/main.cpp uses, for the
+// replay. Captures are served from the frames the harness supplies
+// (replayHardware.h), sensor settings go to the mock sensor (src/sensorMock.cpp).
+// The simulation builds the real driver instead (host/simCamera.h).
+#define ARDUCHIP_TEST1 0x00
+#define ARDUCHIP_TRIG 0x41
+#define CAP_DONE_MASK 0x08
+
+class ArduCAM {
+public:
+  ArduCAM(uint8_t model, int csPin) { (void)model; (void)csPin; }
+  void CS_HIGH() {}
+  void CS_LOW() {}
+
+  void write_reg(uint8_t address, uint8_t value) { registers[address & 0x7F] = value; }
+  uint8_t read_reg(uint8_t address) { return registers[address & 0x7F]; }
+
+  void flush_fifo() {}
+  void clear_fifo_flag() {}
+  void start_capture();
+  uint8_t get_bit(uint8_t address, uint8_t bit);
+  void set_fifo_burst();
+  uint8_t transfer(uint8_t data);
+
+private:
+  uint8_t registers[128] = {};
+};
@@ -0,0 +1,62 @@
+#pragma once
+// Just enough of the Teensy Arduino core to build src/ on a workstation, see
+// host/replay.cpp. Time is simulated (replayHardware.h) so replays are repeatable.
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+#include <string>
+
+#define DMAMEM
+#define FASTRUN
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#define pgm_read_word(address) (*(const uint16_t *)(address))
+typedef uint8_t byte;
+#define HIGH 1
+#define LOW 0
+#define OUTPUT 1
+#define INPUT 0
+#define DEC 10
+#define HEX 16
+
+uint32_t micros();
+uint32_t millis();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+inline void yield() {}
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline void digitalWriteFast(uint8_t, uint8_t) {}
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+// USB serial. Output is collected for the harness, input comes from it.
+class usb_serial_class {
+public:
+  void begin(uint32_t) {}
+  explicit operator bool() const { return true; }
+  int available();
+  int read();
+  int availableForWrite() { return 65536; }
+  size_t write(uint8_t value) { return write(&value, 1); }
+  size_t write(const uint8_t *data, size_t length);
+
+  size_t print(const char *text) { return write((const uint8_t *)text, strlen(text)); }
+  size_t print(const std::string &text) { return print(text.c_str()); }
+  size_t print(char value) { return write((uint8_t)value); }
+  size_t print(long value, int base = DEC);
+  size_t print(unsigned long value, int base = DEC);
+  size_t print(int value, int base = DEC) { return print((long)value, base); }
+  size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+  size_t print(unsigned char value, int base = DEC) { return print((unsigned long)value, base); }
+  size_t print(double value, int digits = 2);
+
+  template <typename T> size_t println(T value) { return print(value) + println(); }
+  template <typename T> size_t println(T value, int format) { return print(value, format) + println(); }
+  size_t println() { return print("\r\n"); }
+};
+extern usb_serial_class Serial;
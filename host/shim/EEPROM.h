@@ -0,0 +1,14 @@
+#pragma once
+#include <Arduino.h>
+
+// Starts erased (0xFF) on every run, the harness can preload it
+class EEPROMClass {
+public:
+  uint8_t read(int address) { return data[address]; }
+  void write(int address, uint8_t value) { data[address] = value; }
+  void update(int address, uint8_t value) { data[address] = value; }
+  uint16_t length() { return sizeof(data); }
+  uint8_t data[4284];
+  EEPROMClass() { memset(data, 0xFF, sizeof(data)); }
+};
+extern EEPROMClass EEPROM;
@@ -0,0 +1,3 @@
+#pragma once
+// Included by lib/ArduCAM, Serial comes from Arduino.h
+#include <Arduino.h>
@@ -0,0 +1,10 @@
+#pragma once
+#include <Arduino.h>
+
+// Callbacks run from the simulated clock as it passes each period
+class IntervalTimer {
+public:
+  bool begin(void (*function)(), uint32_t microseconds);
+  void end();
+  void priority(uint8_t) {}
+};
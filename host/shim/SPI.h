@@ -0,0 +1,12 @@
+#pragma once
+#include <Arduino.h>
+
+// Nothing on the bus: the replay serves frames from its ArduCAM stand-in and
+// the simulated camera (host/simCamera.h) replaces the driver's transport
+class SPIClass {
+public:
+  void begin() {}
+  uint8_t transfer(uint8_t) { return 0; }
+  void transfer(void *buffer, size_t count) { memset(buffer, 0, count); }
+};
+extern SPIClass SPI;
@@ -0,0 +1,11 @@
+#pragma once
+#include <Arduino.h>
+
+class Servo {
+public:
+  uint8_t attach(int p) { pin = p; return 1; }
+  void writeMicroseconds(int value) { pulse = value; }
+  int readMicroseconds() { return pulse; }
+  int pin = -1;
+  int pulse = 1500;
+};
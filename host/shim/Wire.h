@@ -0,0 +1,16 @@
+#pragma once
+#include <Arduino.h>
+
+// Nothing answers, see SPI.h
+class TwoWire {
+public:
+  void begin() {}
+  void setClock(uint32_t) {}
+  void beginTransmission(uint8_t) {}
+  size_t write(uint8_t) { return 1; }
+  size_t write(const uint8_t *, size_t length) { return length; }
+  uint8_t endTransmission() { return 2; } // Address NACK
+  uint8_t requestFrom(uint8_t, uint8_t) { return 0; }
+  int read() { return -1; }
+};
+extern TwoWire Wire;
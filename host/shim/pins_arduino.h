@@ -0,0 +1,2 @@
+#pragma once
+// Included by lib/ArduCAM, nothing needed from it here
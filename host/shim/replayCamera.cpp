@@ -0,0 +1,69 @@
+// ArduCAM stand-in for the replay: captures come from the harness's frame
+// source (replayHardware.h) and complete at their recorded time.
+#include <Arduino.h>
+#include <ArduCAM.h>
+#include <chrono>
+#include "replayHardware.h"
+
+static FrameSource frameSource = nullptr;
+static uint16_t framePixels[320 * 240];
+static uint32_t frameTime = 0;   // Device time the frame was exposed
+static uint32_t fifoPosition = 0; // Bytes read since set_fifo_burst()
+static uint64_t timeBase = 0;    // Recorded device time -> simulated time
+static bool firstFrame = true;
+
+static std::vector<FrameHostTiming> hostTiming;
+static uint32_t captures = 0;
+
+static uint64_t hostNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void setFrameSource(FrameSource source) {
+  frameSource = source;
+}
+
+void endReplayFrame() {
+  if (!hostTiming.empty() && hostTiming.back().processEnd == 0) hostTiming.back().processEnd = hostNanos();
+}
+
+std::vector<FrameHostTiming> takeHostTiming() {
+  std::vector<FrameHostTiming> timing;
+  timing.swap(hostTiming);
+  return timing;
+}
+
+void ArduCAM::start_capture() {
+  endReplayFrame();
+  if (!frameSource || !frameSource(framePixels, frameTime)) throw ReplayFinished();
+  // Recorded timeline, shifted to start at the current simulated time
+  if (firstFrame) {
+    timeBase = simulatedMicros() - frameTime;
+    firstFrame = false;
+  }
+  captures++;
+  registers[ARDUCHIP_TRIG] = 0;
+}
+
+// CAP_DONE once the clock reaches the recorded exposure. Frames recorded
+// closer together than the firmware can go just complete immediately.
+uint8_t ArduCAM::get_bit(uint8_t address, uint8_t bit) {
+  if (address == ARDUCHIP_TRIG && (bit & CAP_DONE_MASK)) {
+    advanceClock(timeBase + frameTime);
+    hostTiming.push_back({ captures, hostNanos(), 0 });
+    return CAP_DONE_MASK;
+  }
+  return registers[address & 0x7F] & bit;
+}
+
+void ArduCAM::set_fifo_burst() {
+  fifoPosition = 0;
+}
+
+// FIFO order is high byte first
+uint8_t ArduCAM::transfer(uint8_t) {
+  uint32_t pixel = fifoPosition / 2;
+  uint16_t value = pixel < 320 * 240 ? framePixels[pixel] : 0;
+  return fifoPosition++ & 1 ? value & 0xFF : value >> 8;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+// Harness side of the shim. The clock only moves when the firmware waits
+// (capture, delay) or, in the simulation, spends time on the camera bus, so a
+// run gives the same outputs every time.
+
+// Simulated clock, micros since boot. Advancing it runs the servo timer for
+// every period passed.
+uint64_t simulatedMicros();
+void advanceClock(uint64_t time);
+
+// Everything the firmware wrote to Serial since the last call
+std::vector<uint8_t> takeSerialOutput();
+
+// Replay camera (host/shim/replayCamera.cpp)
+
+// Fills the frame read out next, 16-bit FIFO words up to 320x240 (recordings
+// are 160x120 RGB565), and its exposure time (device micros). False when out of frames
+typedef bool (*FrameSource)(uint16_t *pixels, uint32_t &timestamp);
+void setFrameSource(FrameSource source);
+
+// Thrown from start_capture() when the source is exhausted
+struct ReplayFinished {};
+
+// Host time (ns) at CAP_DONE and at the next capture (or endReplayFrame()), per frame
+struct FrameHostTiming {
+  uint32_t frame;
+  uint64_t readoutStart;
+  uint64_t processEnd;
+};
+void endReplayFrame();
+std::vector<FrameHostTiming> takeHostTiming();
@@ -0,0 +1,80 @@
+#include <Arduino.h>
+#include <SPI.h>
+#include <Wire.h>
+#include <EEPROM.h>
+#include <IntervalTimer.h>
+#include <stdio.h>
+#include "replayHardware.h"
+
+usb_serial_class Serial;
+SPIClass SPI;
+TwoWire Wire;
+EEPROMClass EEPROM;
+
+// Simulated clock, microseconds since boot
+static uint64_t now = 0;
+
+static void (*timerFunction)() = nullptr;
+static uint32_t timerPeriod = 0;
+static uint64_t timerNext = 0;
+
+// Run the servo timer for every period the clock passes
+void advanceClock(uint64_t time) {
+  while (timerFunction && timerNext <= time) {
+    now = timerNext;
+    timerNext += timerPeriod;
+    timerFunction();
+  }
+  if (time > now) now = time;
+}
+
+uint64_t simulatedMicros() { return now; }
+uint32_t micros() { return now; }
+uint32_t millis() { return now / 1000; }
+void delay(uint32_t ms) { advanceClock(now + ms * 1000ull); }
+void delayMicroseconds(uint32_t us) { advanceClock(now + us); }
+
+bool IntervalTimer::begin(void (*function)(), uint32_t microseconds) {
+  timerFunction = function;
+  timerPeriod = microseconds;
+  timerNext = now + microseconds;
+  return true;
+}
+
+void IntervalTimer::end() {
+  timerFunction = nullptr;
+}
+
+// Serial
+static std::vector<uint8_t> serialOutput;
+
+int usb_serial_class::available() { return 0; }
+int usb_serial_class::read() { return -1; }
+
+size_t usb_serial_class::write(const uint8_t *data, size_t length) {
+  serialOutput.insert(serialOutput.end(), data, data + length);
+  return length;
+}
+
+size_t usb_serial_class::print(long value, int base) {
+  if (value < 0 && base == DEC) return print('-') + print((unsigned long)-value, base);
+  return print((unsigned long)value, base);
+}
+
+size_t usb_serial_class::print(unsigned long value, int base) {
+  char text[24];
+  snprintf(text, sizeof(text), base == HEX ? "%lX" : "%lu", value);
+  return print(text);
+}
+
+size_t usb_serial_class::print(double value, int digits) {
+  char text[48];
+  snprintf(text, sizeof(text), "%.*f", digits, value);
+  return print(text);
+}
+
+std::vector<uint8_t> takeSerialOutput() {
+  std::vector<uint8_t> output;
+  output.swap(serialOutput);
+  return output;
+}
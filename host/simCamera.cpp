@@ -0,0 +1,288 @@
+#include "simCamera.h"
+#include <string.h>
+#include <vector>
+#include "replayHardware.h"
+
+static SimCameraConfig config;
+static SimScene scene;
+SimCameraStats simCameraStats;
+
+// Simulated time the bus has used but not yet given to the clock
+static uint64_t busNanos = 0;
+
+static void spend(uint64_t nanos) {
+  busNanos += nanos;
+  if (busNanos < 1000) return;
+  uint64_t micros = busNanos / 1000;
+  busNanos %= 1000;
+  simCameraStats.busMicros += micros;
+  advanceClock(simulatedMicros() + micros);
+}
+
+// OV2640
+
+constexpr uint8_t sensorAddress = 0x30; // 0x60 in the driver's 8-bit form
+constexpr uint16_t inputWidth = 800, inputHeight = 600;
+
+static uint8_t sensorRegs[2][256]; // DSP (bank 0), sensor (bank 1)
+static uint8_t sensorPointer = 0;
+
+static void resetSensor() {
+  memset(sensorRegs, 0, sizeof(sensorRegs));
+  sensorRegs[1][0x0a] = 0x26; // PIDH
+  sensorRegs[1][0x0b] = 0x42; // PIDL
+  sensorRegs[1][0x13] = 0xe5; // COM8, AEC/AGC on
+}
+
+static uint8_t sensorBank() {
+  return sensorRegs[0][0xff] & 0x01;
+}
+
+static void writeSensor(uint8_t reg, uint8_t value) {
+  if (reg == 0xff) {
+    sensorRegs[0][0xff] = sensorRegs[1][0xff] = value;
+    return;
+  }
+  uint8_t bank = sensorBank();
+  if (bank == 1 && reg == 0x12 && (value & 0x80)) {
+    resetSensor();
+    return;
+  }
+  sensorRegs[bank][reg] = value;
+}
+
+uint32_t simFramePeriod() {
+  const uint8_t *s = sensorRegs[1];
+  uint32_t period = config.framePeriod * ((s[0x11] & 0x3f) + 1);
+  if (!(s[0x13] & 0x01)) {
+    uint32_t lines = ((s[0x45] & 0x3f) << 10) | (s[0x10] << 2) | (s[0x04] & 0x03);
+    if (lines > config.frameLines) period = (uint64_t)period * lines / config.frameLines;
+  }
+  return period;
+}
+
+// Window on the DSP input and output size, decoded as OV2640_set_window() writes them
+struct SensorOutput {
+  uint16_t x, y, width, height;
+  uint16_t outWidth, outHeight;
+  bool yuv;
+};
+
+static SensorOutput sensorOutput() {
+  const uint8_t *d = sensorRegs[0];
+  uint8_t vhyx = d[0x55];
+  SensorOutput out;
+  out.width = (d[0x51] | ((vhyx & 0x08) << 5) | ((d[0x57] & 0x80) << 2)) * 4;
+  out.height = (d[0x52] | ((vhyx & 0x80) << 1)) * 4;
+  out.x = d[0x53] | ((vhyx & 0x07) << 8);
+  out.y = d[0x54] | ((vhyx & 0x70) << 4);
+  out.outWidth = (d[0x5a] | ((d[0x5c] & 0x03) << 8)) * 4;
+  out.outHeight = (d[0x5b] | ((d[0x5c] & 0x04) << 6)) * 4;
+  out.yuv = (d[0xda] & 0x0c) == 0x00;
+  if (out.width == 0 || out.height == 0) {
+    out.x = out.y = 0;
+    out.width = inputWidth;
+    out.height = inputHeight;
+  }
+  return out;
+}
+
+// ArduChip
+
+static uint8_t chipRegs[128];
+static std::vector<uint8_t> fifo;
+static uint32_t fifoRead = 0;
+
+static uint64_t lastVsync = 0;
+static bool capturing = false, rendered = false, captureDone = false;
+static uint64_t captureStart = 0, captureEnd = 0;
+
+static void syncVsync(uint64_t now) {
+  uint32_t period = simFramePeriod();
+  if (now >= lastVsync + period) lastVsync += (now - lastVsync) / period * period;
+}
+
+static void putRgb565(uint8_t r, uint8_t g, uint8_t b) {
+  uint16_t value = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+  fifo.push_back(value >> 8); // High byte first
+  fifo.push_back(value & 0xff);
+}
+
+static void toYuv(uint8_t r, uint8_t g, uint8_t b, int &y, int &u, int &v) {
+  y = (77 * r + 150 * g + 29 * b) >> 8;
+  u = ((-43 * r - 85 * g + 128 * b) >> 8) + 128;
+  v = ((128 * r - 107 * g - 21 * b) >> 8) + 128;
+}
+
+static uint8_t clampByte(int value) {
+  return value < 0 ? 0 : value > 255 ? 255 : value;
+}
+
+static void renderFrame() {
+  SensorOutput out = sensorOutput();
+  scene.prepare(captureStart + (captureEnd - captureStart) / 2);
+  fifo.clear();
+  fifoRead = 0;
+  rendered = true;
+  if (out.outWidth == 0 || out.outHeight == 0) return;
+  fifo.reserve((size_t)out.outWidth * out.outHeight * 2);
+  float stepX = (float)out.width / out.outWidth, stepY = (float)out.height / out.outHeight;
+  for (int oy = 0; oy < out.outHeight; oy++) {
+    float y = (out.y + (oy + 0.5f) * stepY) / inputHeight;
+    for (int ox = 0; ox < out.outWidth; ox += 2) {
+      uint8_t r0, g0, b0, r1, g1, b1;
+      scene.sample((out.x + (ox + 0.5f) * stepX) / inputWidth, y, r0, g0, b0);
+      scene.sample((out.x + (ox + 1.5f) * stepX) / inputWidth, y, r1, g1, b1);
+      if (out.yuv) {
+        int y0, u0, v0, y1, u1, v1;
+        toYuv(r0, g0, b0, y0, u0, v0);
+        toYuv(r1, g1, b1, y1, u1, v1);
+        fifo.push_back(clampByte(y0));
+        fifo.push_back(clampByte((u0 + u1) / 2));
+        fifo.push_back(clampByte(y1));
+        fifo.push_back(clampByte((v0 + v1) / 2));
+      } else {
+        putRgb565(r0, g0, b0);
+        putRgb565(r1, g1, b1);
+      }
+    }
+  }
+}
+
+// Capture progress as of now, called on every bus access
+static void updateCapture() {
+  if (!capturing) return;
+  uint64_t now = simulatedMicros();
+  if (!rendered && now >= captureStart + (captureEnd - captureStart) / 2) renderFrame();
+  if (now >= captureEnd) {
+    if (!rendered) renderFrame();
+    capturing = false;
+    captureDone = true;
+    simCameraStats.captures++;
+  }
+}
+
+static void startCapture() {
+  uint64_t now = simulatedMicros();
+  syncVsync(now);
+  uint32_t period = simFramePeriod();
+  captureStart = lastVsync + period; // Next VSYNC
+  captureEnd = captureStart + period;
+  capturing = true;
+  rendered = false;
+  captureDone = false;
+  fifo.clear();
+  fifoRead = 0;
+}
+
+static void writeChip(uint8_t address, uint8_t value) {
+  chipRegs[address] = value;
+  if (address == ARDUCHIP_FIFO) {
+    if (value & FIFO_CLEAR_MASK) captureDone = false;
+    if (value & FIFO_RDPTR_RST_MASK) fifoRead = 0;
+    if (value & FIFO_START_MASK) startCapture();
+  }
+}
+
+static uint8_t readChip(uint8_t address) {
+  uint32_t length = captureDone ? fifo.size() : 0;
+  switch (address) {
+    case ARDUCHIP_TRIG: return captureDone ? CAP_DONE_MASK : 0;
+    case FIFO_SIZE1: return length & 0xff;
+    case FIFO_SIZE2: return (length >> 8) & 0xff;
+    case FIFO_SIZE3: return (length >> 16) & 0x7f;
+    default: return chipRegs[address];
+  }
+}
+
+static uint8_t readFifo() {
+  return captureDone && fifoRead < fifo.size() ? fifo[fifoRead++] : 0;
+}
+
+// SPI: an address byte after chip select (bit 7 = write), then the value,
+// or FIFO bytes after a burst read until deselected
+enum SpiPhase { SPI_ADDRESS, SPI_WRITE, SPI_READ, SPI_BURST, SPI_SINGLE, SPI_DONE };
+static SpiPhase spiPhase = SPI_DONE;
+static uint8_t spiAddress = 0;
+
+static void simSelect(bool selected) {
+  spiPhase = selected ? SPI_ADDRESS : SPI_DONE;
+}
+
+static uint8_t simTransfer(uint8_t data) {
+  spend(8000000000ull / config.spiClock);
+  simCameraStats.spiBytes++;
+  updateCapture();
+  switch (spiPhase) {
+    case SPI_ADDRESS:
+      if (data == BURST_FIFO_READ) spiPhase = SPI_BURST;
+      else if (data == SINGLE_FIFO_READ) spiPhase = SPI_SINGLE;
+      else {
+        spiAddress = data & 0x7f;
+        spiPhase = data & 0x80 ? SPI_WRITE : SPI_READ;
+      }
+      return 0;
+    case SPI_WRITE:
+      spiPhase = SPI_DONE;
+      writeChip(spiAddress, data);
+      return 0;
+    case SPI_READ:
+      spiPhase = SPI_DONE;
+      return readChip(spiAddress);
+    case SPI_BURST:
+      return readFifo();
+    case SPI_SINGLE:
+      spiPhase = SPI_DONE;
+      return readFifo();
+    default:
+      return 0;
+  }
+}
+
+static void simTransfers(uint8_t *buf, uint32_t size) {
+  for (uint32_t i = 0; i < size; i++) buf[i] = simTransfer(buf[i]);
+}
+
+// Address byte, data bytes, ACKs, start and stop
+static void spendI2c(uint8_t length) {
+  spend((uint64_t)((length + 1) * 9 + 2) * 1000000000ull / config.i2cClock);
+  updateCapture();
+}
+
+static uint8_t simI2cWrite(uint8_t addr, const uint8_t *data, uint8_t length) {
+  spendI2c(length);
+  if (addr != sensorAddress) return 2; // Address NACK
+  if (length >= 1) sensorPointer = data[0];
+  if (length >= 2) {
+    writeSensor(data[0], data[1]);
+    simCameraStats.sensorWrites++;
+    uint64_t now = simulatedMicros();
+    if (capturing && now >= captureStart && now < captureEnd) simCameraStats.writesDuringCapture++;
+  }
+  return 0;
+}
+
+static uint8_t simI2cRead(uint8_t addr, uint8_t *data, uint8_t length) {
+  spendI2c(length);
+  if (addr != sensorAddress) return 0;
+  for (uint8_t i = 0; i < length; i++) data[i] = sensorRegs[sensorBank()][(uint8_t)(sensorPointer + i)];
+  simCameraStats.sensorReads++;
+  return length;
+}
+
+const ArduCAM_transport simCameraTransport = {
+  simSelect, simTransfer, simTransfers, simI2cWrite, simI2cRead
+};
+
+void initSimCamera(const SimCameraConfig &cameraConfig, const SimScene &cameraScene) {
+  config = cameraConfig;
+  scene = cameraScene;
+  simCameraStats = SimCameraStats();
+  resetSensor();
+  memset(chipRegs, 0, sizeof(chipRegs));
+  fifo.clear();
+  fifoRead = 0;
+  capturing = rendered = captureDone = false;
+  lastVsync = simulatedMicros();
+  spiPhase = SPI_DONE;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <stdint.h>
+#include <ArduCAM.h>
+
+// Simulated ArduCAM Mini 2MP Plus behind the driver's transport: the ArduChip
+// (SPI registers, capture trigger, FIFO) and an OV2640 on I2C. Bus traffic
+// costs simulated time at the configured clocks, so the capture wait, FIFO
+// readout and the sensor write queue's budget behave as on the board.
+//
+// The sensor free-runs, one VSYNC per frame period: CLKRC scales the period
+// and, with AEC off, exposures longer than a frame stretch it. FIFO_START
+// captures the next whole frame and raises CAP_DONE at its end. The frame is
+// rendered at the first bus access after mid-exposure, through the window,
+// output size and format the registers hold at that point. Only the CIF
+// timing (800x600 DSP input, what every Resolution uses) is modelled.
+
+struct SimCameraConfig {
+  uint32_t framePeriod = 20000; // micros at CLKRC divider 0
+  uint16_t frameLines = 672;    // Exposure lines in one frame period
+  uint32_t spiClock = 8000000;
+  uint32_t i2cClock = 400000;
+};
+
+// What the sensor looks at. prepare() runs once per frame at mid-exposure
+// (simulated micros), sample() then gives the colour at (x, y) of the sensor
+// view, both in [0, 1) across the full DSP input.
+struct SimScene {
+  void (*prepare)(uint64_t time);
+  void (*sample)(float x, float y, uint8_t &r, uint8_t &g, uint8_t &b);
+};
+
+struct SimCameraStats {
+  uint32_t captures;      // CAP_DONE raised
+  uint64_t spiBytes;
+  uint32_t sensorWrites;  // I2C register writes acked
+  uint32_t writesDuringCapture; // Of those, landed inside a captured frame
+  uint32_t sensorReads;
+  uint64_t busMicros;     // Simulated time spent on SPI and I2C
+};
+
+extern const ArduCAM_transport simCameraTransport;
+extern SimCameraStats simCameraStats;
+
+void initSimCamera(const SimCameraConfig &config, const SimScene &scene);
+// Current frame period (micros), as the registers set it
+uint32_t simFramePeriod();
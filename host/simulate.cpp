@@ -0,0 +1,350 @@
+// Runs the firmware on a workstation against a simulated camera. src/ and the
+// real ArduCAM driver, OV2640 sensor code included, talk to host/simCamera
+// through the driver's transport, so capture timing, FIFO readout and sensor
+// writes take the simulated time they would on the board.
+//
+//   g++ -O2 -std=gnu++17 -DTEENSYDUINO -Ilib/ArduCAM -Ihost/shim -Isrc -Ihost src/*.cpp lib/ArduCAM/ArduCAM.cpp
+//       host/shim/shim.cpp host/archive.cpp host/simCamera.cpp host/simulate.cpp -o simulate
+//   ./simulate --frames 600 > run.csv           target moving in front of the rig, closed loop
+//   ./simulate --archive capture.ebmv           frames of a recording, open loop
+//   ./simulate --step 10,5                      static target at (azimuth, elevation), settling and overshoot
+//   ./simulate --legacy-servo                   the original per-frame integer P loop instead of the firmware's
+//   ./simulate --no-timing                      outputs only, identical every run
+//   --frame-period us (at CLKRC 0), --spi-clock Hz, --i2c-clock Hz
+//   --set name=value                            firmware parameter (commands.h), after setup()
+//
+// TEENSYDUINO builds the driver as it is configured for the board. The
+// moving target is seen through the pose the servo outputs command, so the
+// loop closes through the tracker and servo controller. Simulated time covers
+// the bus and the waits only; the cost of the vision code itself is the host
+// time per frame reported at the end.
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+#include <Servo.h>
+#include "archive.h"
+#include "protocol.h"
+#include "telemetry.h"
+#include "servoControl.h"
+#include "params.h"
+#include "camera.h"
+#include "replayHardware.h"
+#include "simCamera.h"
+
+void setup();
+void loop();
+extern ArduCAM myCAM;
+extern Servo SERVOH, SERVOV;
+
+constexpr float pi = 3.14159265f;
+constexpr float degToRad = pi / 180.0f;
+
+// Rig, as the firmware's defaults assume it (cameraHFov, invertX, invertY in
+// main.cpp): increasing either servo angle turns the camera left / down
+constexpr float sceneHFov = 60.0f;
+constexpr float panSign = -1.0f, tiltSign = -1.0f;
+constexpr float inputWidth = 800, inputHeight = 600;
+static const float focal = inputWidth * 0.5f / tanf(sceneHFov * 0.5f * degToRad); // DSP input pixels
+
+static float servoDegrees(Servo &servo) {
+  return (servo.readMicroseconds() - servoMinMicros) * 180.0f / (servoMaxMicros - servoMinMicros);
+}
+
+// Controller the firmware had before servoControl: once per frame, integer
+// degrees, proportional on the centroid's pixel offset outside a deadzone.
+// With --legacy-servo it drives the rig from the MSG_BLOBS records and the
+// firmware's servo outputs are ignored.
+constexpr int legacyDeadzone = 5;  // Pixels
+constexpr float legacyKp = 0.1f;   // Degrees per pixel per frame
+static bool legacyServo = false;
+static int legacyPan = 90, legacyTilt = 90;
+
+static void legacyTrack(const FrameRecord &r) {
+  if (r.blobCount == 0 || r.targetX < 0 || r.targetY < 0) return;
+  int errorX = -(r.targetX - frameWidth / 2); // invertX
+  int errorY = r.targetY - frameHeight / 2;
+  if (abs(errorX) > legacyDeadzone) legacyPan = std::max(0, std::min((int)(legacyPan + errorX * legacyKp), 180));
+  if (abs(errorY) > legacyDeadzone) legacyTilt = std::max(0, std::min((int)(legacyTilt + errorY * legacyKp), 180));
+}
+
+static float rigPan() {
+  return legacyServo ? legacyPan : servoDegrees(SERVOH);
+}
+
+static float rigTilt() {
+  return legacyServo ? legacyTilt : servoDegrees(SERVOV);
+}
+
+// Where the optical axis points (world degrees) for a servo pose
+static float viewAzimuth(float pan) {
+  return (pan - 90.0f) * panSign;
+}
+
+static float viewElevation(float tilt) {
+  return (tilt - 90.0f) * tiltSign;
+}
+
+// Truth at each frame's mid-exposure, for the error columns
+struct SceneTruth {
+  uint64_t time;
+  float azimuth, elevation; // Target, world degrees
+  float pan, tilt;          // Camera pose, servo degrees
+};
+static std::vector<SceneTruth> truth;
+
+// Procedural scene: a red disc on a Lissajous path (or held still with
+// --step) over a world-fixed checkerboard. Colours are inside / well outside
+// the default thresholds.
+constexpr float targetRadius = 1.5f; // degrees
+constexpr float pathAzimuth = 12.0f, pathElevation = 6.0f;
+constexpr float pathPeriodH = 6.0f, pathPeriodV = 4.3f; // seconds
+static bool stepScene = false;
+static float stepAzimuth = 0, stepElevation = 0;
+constexpr float settledError = 1.0f; // degrees, ~2.7 px at 160x120
+
+static float targetX, targetY, targetR; // DSP input pixels, this frame
+static bool targetVisible = false;
+static float viewPan, viewTilt;
+
+// Direction (azimuth, elevation) -> DSP input pixel for the camera at (pan, tilt),
+// the inverse of pixelToWorld() in src/kinematics.cpp
+static bool worldToInput(float azimuth, float elevation, float pan, float tilt, float &px, float &py) {
+  float ce = cosf(elevation * degToRad);
+  float x2 = ce * sinf(azimuth * degToRad), y1 = sinf(elevation * degToRad), z2 = ce * cosf(azimuth * degToRad);
+  float panAngle = viewAzimuth(pan) * degToRad, tiltAngle = viewElevation(tilt) * degToRad;
+  float cp = cosf(panAngle), sp = sinf(panAngle);
+  float x = x2 * cp - z2 * sp;
+  float z1 = x2 * sp + z2 * cp;
+  float ct = cosf(tiltAngle), st = sinf(tiltAngle);
+  float y = y1 * ct - z1 * st;
+  float z = y1 * st + z1 * ct;
+  if (z <= 0) return false;
+  px = inputWidth * 0.5f + focal * x / z;
+  py = inputHeight * 0.5f - focal * y / z;
+  return true;
+}
+
+static void preparePath(uint64_t time) {
+  float t = time * 1e-6f;
+  SceneTruth now = { time, pathAzimuth * sinf(2 * pi * t / pathPeriodH), pathElevation * sinf(2 * pi * t / pathPeriodV),
+                     rigPan(), rigTilt() };
+  if (stepScene) {
+    now.azimuth = stepAzimuth;
+    now.elevation = stepElevation;
+  }
+  truth.push_back(now);
+  viewPan = now.pan;
+  viewTilt = now.tilt;
+  targetVisible = worldToInput(now.azimuth, now.elevation, now.pan, now.tilt, targetX, targetY);
+  targetR = focal * tanf(targetRadius * degToRad);
+}
+
+static uint32_t hashNoise(int x, int y) {
+  uint32_t h = x * 374761393u + y * 668265263u;
+  h = (h ^ (h >> 13)) * 1274126177u;
+  return h ^ (h >> 16);
+}
+
+static void samplePath(float x, float y, uint8_t &r, uint8_t &g, uint8_t &b) {
+  float px = x * inputWidth, py = y * inputHeight;
+  float dx = px - targetX, dy = py - targetY;
+  if (targetVisible && dx * dx + dy * dy < targetR * targetR) {
+    r = 200, g = 30, b = 30;
+    return;
+  }
+  // Small-angle world position for the background, good enough to see it move
+  float azimuth = viewAzimuth(viewPan) + (px - inputWidth * 0.5f) / focal / degToRad;
+  float elevation = viewElevation(viewTilt) - (py - inputHeight * 0.5f) / focal / degToRad;
+  bool dark = ((int)floorf(azimuth / 8.0f) + (int)floorf(elevation / 8.0f)) & 1;
+  int noise = (int)(hashNoise((int)px, (int)py) & 15) - 8;
+  r = (dark ? 70 : 120) + noise;
+  g = (dark ? 90 : 140) + noise;
+  b = (dark ? 80 : 125) + noise;
+}
+
+// Recorded scene: each capture takes the next frame of the archive, stretched
+// over the whole sensor view
+static Archive archive;
+static ArchiveFrames archiveFrames;
+static uint16_t archivePixels[archiveFrameWidth * archiveFrameHeight];
+static bool archiveFinished = false;
+
+static void prepareArchive(uint64_t time) {
+  uint32_t timestamp;
+  if (!nextArchiveFrame(archive, archiveFrames, archivePixels, timestamp)) archiveFinished = true;
+  truth.push_back({ time, 0, 0, rigPan(), rigTilt() });
+}
+
+static void sampleArchive(float x, float y, uint8_t &r, uint8_t &g, uint8_t &b) {
+  int ix = std::min((int)(x * archiveFrameWidth), archiveFrameWidth - 1);
+  int iy = std::min((int)(y * archiveFrameHeight), archiveFrameHeight - 1);
+  uint16_t pixel = archivePixels[iy * archiveFrameWidth + ix];
+  r = ((pixel >> 11) << 3) | (pixel >> 13);
+  g = (((pixel >> 5) & 0x3f) << 2) | ((pixel >> 9) & 0x03);
+  b = ((pixel & 0x1f) << 3) | ((pixel >> 2) & 0x07);
+}
+
+// Firmware telemetry -> one CSV line per MSG_BLOBS
+static StreamParser parser;
+static uint8_t parserPayload[4096];
+static bool recordedScene = false;
+static uint64_t captureMicrosTotal = 0, readoutMicrosTotal = 0, records = 0;
+static double squaredAimError = 0, totalAimError = 0;
+static uint64_t aimSamples = 0;
+static uint64_t firstSample = 0, lastSample = 0, lastUnsettled = 0; // Simulated micros, --step
+static float overshoot = 0, finalError = 0;          // Degrees past the target along the step, error at the end
+
+// First frame exposed after the trigger. Records arrive in order, so search from the end.
+static const SceneTruth *truthFor(uint32_t captureStart) {
+  const SceneTruth *found = nullptr;
+  for (auto t = truth.rbegin(); t != truth.rend() && t->time > captureStart; ++t) found = &*t;
+  return found;
+}
+
+static void printRecord(const FrameRecord &r) {
+  const SceneTruth *t = truthFor(r.captureStart);
+  float aimError = -1;
+  if (t && !recordedScene) {
+    float dAz = t->azimuth - viewAzimuth(t->pan), dEl = t->elevation - viewElevation(t->tilt);
+    aimError = sqrtf(dAz * dAz + dEl * dEl);
+    squaredAimError += aimError * aimError;
+    totalAimError += aimError;
+    if (aimSamples++ == 0) firstSample = lastUnsettled = t->time;
+    if (aimError > settledError) lastUnsettled = t->time;
+    lastSample = t->time;
+    finalError = aimError;
+    float step = sqrtf(stepAzimuth * stepAzimuth + stepElevation * stepElevation);
+    if (step > 0) {
+      float along = (viewAzimuth(t->pan) * stepAzimuth + viewElevation(t->tilt) * stepElevation) / step;
+      overshoot = std::max(overshoot, along - step);
+    }
+  }
+  captureMicrosTotal += r.captureMicros;
+  readoutMicrosTotal += r.readoutMicros;
+  records++;
+  printf("%u,%u,%u,%u,%u,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n", r.frame, r.captureStart, r.captureMicros,
+         r.readoutMicros, r.blobCount, r.targetX, r.targetY, r.azimuth, r.elevation, t ? t->azimuth : 0.0f,
+         t ? t->elevation : 0.0f, r.panActual, r.tiltActual, aimError);
+}
+
+static void drainOutput() {
+  serviceTelemetry();
+  std::vector<uint8_t> output = takeSerialOutput();
+  size_t offset = 0;
+  while (offset < output.size()) {
+    bool complete;
+    offset += parseStream(parser, output.data() + offset, output.size() - offset, complete);
+    if (!complete || parser.current.type != MSG_BLOBS) continue;
+    FrameRecord record;
+    if (!decodeFrameRecord(parserPayload, parser.current.length, record)) continue;
+    printRecord(record);
+    if (legacyServo) legacyTrack(record);
+  }
+}
+
+static uint64_t hostNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// name=value against the firmware's parameter table
+static bool setNamedParameter(const char *assignment) {
+  const char *equals = strchr(assignment, '=');
+  if (!equals) return false;
+  for (int i = 0; i < parameterCount; i++) {
+    const Parameter &p = parameters[i];
+    if (strlen(p.name) == (size_t)(equals - assignment) && strncmp(p.name, assignment, equals - assignment) == 0) {
+      return setParameter(p, strtof(equals + 1, nullptr));
+    }
+  }
+  return false;
+}
+
+int main(int argc, char **argv) {
+  SimCameraConfig config;
+  const char *archivePath = nullptr;
+  std::vector<const char *> assignments;
+  uint32_t frameLimit = 600;
+  bool showTiming = true;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--no-timing") == 0) showTiming = false;
+    else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) frameLimit = strtoul(argv[++i], nullptr, 10);
+    else if (strcmp(argv[i], "--archive") == 0 && i + 1 < argc) archivePath = argv[++i];
+    else if (strcmp(argv[i], "--frame-period") == 0 && i + 1 < argc) config.framePeriod = strtoul(argv[++i], nullptr, 10);
+    else if (strcmp(argv[i], "--spi-clock") == 0 && i + 1 < argc) config.spiClock = strtoul(argv[++i], nullptr, 10);
+    else if (strcmp(argv[i], "--i2c-clock") == 0 && i + 1 < argc) config.i2cClock = strtoul(argv[++i], nullptr, 10);
+    else if (strcmp(argv[i], "--set") == 0 && i + 1 < argc) assignments.push_back(argv[++i]);
+    else if (strcmp(argv[i], "--step") == 0 && i + 1 < argc &&
+             sscanf(argv[++i], "%f,%f", &stepAzimuth, &stepElevation) == 2) stepScene = true;
+    else if (strcmp(argv[i], "--legacy-servo") == 0) legacyServo = true;
+    else {
+      fprintf(stderr, "usage: %s [--frames N] [--archive file] [--no-timing] [--frame-period us] "
+                      "[--spi-clock Hz] [--i2c-clock Hz] [--set name=value]... [--step az,el] [--legacy-servo]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (config.framePeriod == 0 || config.spiClock == 0 || config.i2cClock == 0) {
+    fprintf(stderr, "frame period and clocks must be non-zero\n");
+    return 1;
+  }
+
+  SimScene scene = { preparePath, samplePath };
+  if (archivePath) {
+    if (!openArchive(archive, archivePath)) {
+      fprintf(stderr, "can't open %s\n", archivePath);
+      return 1;
+    }
+    scene = { prepareArchive, sampleArchive };
+    recordedScene = true;
+  }
+
+  initParser(parser, parserPayload, sizeof(parserPayload));
+  initSimCamera(config, scene);
+  myCAM.set_transport(&simCameraTransport);
+  printf("frame,captureStart,captureMicros,readoutMicros,blobs,targetX,targetY,azimuth,elevation,"
+         "trueAzimuth,trueElevation,panActual,tiltActual,aimError\n");
+
+  uint64_t hostStart = hostNanos();
+  setup();
+  blobsOut = 1; // The output below
+  for (const char *assignment : assignments) {
+    if (!setNamedParameter(assignment)) {
+      fprintf(stderr, "can't set %s\n", assignment);
+      return 1;
+    }
+  }
+  uint64_t loopStart = hostNanos(), simulatedStart = simulatedMicros();
+  uint32_t firstCapture = simCameraStats.captures;
+  while (simCameraStats.captures < frameLimit && !archiveFinished) {
+    loop();
+    drainOutput();
+  }
+  uint64_t hostEnd = hostNanos();
+  if (recordedScene) closeArchive(archive);
+
+  uint32_t frames = simCameraStats.captures - firstCapture;
+  double simulatedSeconds = (simulatedMicros() - simulatedStart) * 1e-6;
+  fprintf(stderr, "%u frames in %.2f s simulated (%.1f fps), capture wait %.0f us, readout %.0f us per frame\n",
+          frames, simulatedSeconds, simulatedSeconds > 0 ? frames / simulatedSeconds : 0.0,
+          records ? (double)captureMicrosTotal / records : 0.0, records ? (double)readoutMicrosTotal / records : 0.0);
+  fprintf(stderr, "bus: %llu SPI bytes, %u sensor writes (%u inside a captured frame), %u reads, %.2f s busy\n",
+          (unsigned long long)simCameraStats.spiBytes, simCameraStats.sensorWrites, simCameraStats.writesDuringCapture,
+          simCameraStats.sensorReads, simCameraStats.busMicros * 1e-6);
+  fprintf(stderr, "frame period: measured %u us, sensor %u us\n", sensorFramePeriod, simFramePeriod());
+  if (aimSamples) {
+    fprintf(stderr, "aim error RMS %.2f deg, mean %.2f deg\n", sqrt(squaredAimError / aimSamples),
+            totalAimError / aimSamples);
+  }
+  if (stepScene && aimSamples) {
+    if (lastUnsettled == lastSample) fprintf(stderr, "step: not settled within %.1f deg", settledError);
+    else fprintf(stderr, "step: settled within %.1f deg after %.2f s", settledError, (lastUnsettled - firstSample) * 1e-6);
+    fprintf(stderr, ", overshoot %.2f deg, final error %.2f deg\n", overshoot, finalError);
+  }
+  if (showTiming && frames) {
+    fprintf(stderr, "host: setup %.1f ms, %.1f us per frame\n", (loopStart - hostStart) * 1e-6,
+            (hostEnd - loopStart) * 1e-3 / frames);
+  }
+  return 0;
+}
@@ -117,13 +117,50 @@
 #endif
 
 
+#if !defined (RASPBERRY_PI)
+static uint8_t hardware_transfer(uint8_t data)
+{
+	return SPI.transfer(data);
+}
+
+static void hardware_transfers(uint8_t *buf, uint32_t size)
+{
+	SPI.transfer(buf, size);
+}
+
+static uint8_t hardware_i2c_write(uint8_t addr, const uint8_t *data, uint8_t length)
+{
+	Wire.beginTransmission(addr);
+	Wire.write(data, length);
+	return Wire.endTransmission();
+}
+
+static uint8_t hardware_i2c_read(uint8_t addr, uint8_t *data, uint8_t length)
+{
+	uint8_t count = Wire.requestFrom(addr, length);
+	for (uint8_t i = 0; i < count; i++)
+		data[i] = Wire.read();
+	return count;
+}
+
+const ArduCAM_transport ArduCAM_hardware = {
+	NULL, hardware_transfer, hardware_transfers, hardware_i2c_write, hardware_i2c_read
+};
+#else
+const ArduCAM_transport ArduCAM_hardware = { NULL, NULL, NULL, NULL, NULL };
+#endif
+
 ArduCAM::ArduCAM()
 {
   sensor_model = OV7670;
   sensor_addr = 0x42;
+  bus = &ArduCAM_hardware;
+  OV2640_shadow_reset();
 }
 ArduCAM::ArduCAM(byte model ,int CS)
 {
+	bus = &ArduCAM_hardware;
+	OV2640_shadow_reset();
 	#if defined (RASPBERRY_PI)
 		if(CS>=0)
 		{
@@ -389,21 +426,25 @@ void ArduCAM::InitCAM()
 #if (defined(OV2640_CAM) || defined(OV2640_MINI_2MP) || defined(OV2640_MINI_2MP_PLUS))
         wrSensorReg8_8(0xff, 0x01);
         wrSensorReg8_8(0x12, 0x80);
-        delay(100);
+        OV2640_wait_ready(100);
         if (m_fmt == JPEG)
         {
-          wrSensorRegs8_8(OV2640_JPEG_INIT);
+          wrSensorRegs8_8(OV2640_TABLE(OV2640_JPEG_SENSOR));
+          wrSensorRegs8_8(OV2640_TABLE(OV2640_INIT_DSP));
+          wrSensorRegs8_8(OV2640_TABLE(OV2640_JPEG_OUTPUT));
           wrSensorRegs8_8(OV2640_YUV422);
           wrSensorRegs8_8(OV2640_JPEG);
           wrSensorReg8_8(0xff, 0x01);
           wrSensorReg8_8(0x15, 0x00);
-          wrSensorRegs8_8(OV2640_320x240_JPEG);
+          OV2640_set_JPEG_size(OV2640_320x240);
           //wrSensorReg8_8(0xff, 0x00);
           //wrSensorReg8_8(0x44, 0x32);
         }
         else
         {
-          wrSensorRegs8_8(OV2640_QVGA);
+          wrSensorRegs8_8(OV2640_TABLE(OV2640_QVGA_SENSOR));
+          wrSensorRegs8_8(OV2640_TABLE(OV2640_INIT_DSP));
+          wrSensorRegs8_8(OV2640_TABLE(OV2640_QVGA_OUTPUT));
         }
 #endif
         break;
@@ -690,38 +731,44 @@ uint32_t ArduCAM::read_fifo_length(void)
 	return length;	
 }
 
-#if defined (RASPBERRY_PI)
 uint8_t ArduCAM::transfer(uint8_t data)
 {
+#if defined (RASPBERRY_PI)
   uint8_t temp;
   temp = arducam_spi_transfer(data);
   return temp;
+#else
+  return bus->transfer(data);
+#endif
 }
 
 void ArduCAM::transfers(uint8_t *buf, uint32_t size)
 {
+#if defined (RASPBERRY_PI)
 	arducam_spi_transfers(buf, size);
-}
-
+#else
+	bus->transfers(buf, size);
 #endif
+}
 
 void ArduCAM::set_fifo_burst()
 {
-	#if defined (RASPBERRY_PI)
 	transfer(BURST_FIFO_READ);
-	#else
-    SPI.transfer(BURST_FIFO_READ);
-   #endif
-		
 }
 
 void ArduCAM::CS_HIGH(void)
 {
-	 sbi(P_CS, B_CS);	
+	if (bus->select)
+		bus->select(false);
+	else
+		sbi(P_CS, B_CS);
 }
 void ArduCAM::CS_LOW(void)
 {
-	 cbi(P_CS, B_CS);	
+	if (bus->select)
+		bus->select(true);
+	else
+		cbi(P_CS, B_CS);
 }
 
 uint8_t ArduCAM::read_fifo(void)
@@ -800,50 +847,34 @@ void ArduCAM::set_mode(uint8_t mode)
 
 uint8_t ArduCAM::bus_write(int address,int value)
 {	
-	cbi(P_CS, B_CS);
+	CS_LOW();
 	#if defined (RASPBERRY_PI)
 		arducam_spi_write(address | 0x80, value);
 	#else
-		SPI.transfer(address);
-		SPI.transfer(value);
+		bus->transfer(address);
+		bus->transfer(value);
 	#endif
-	sbi(P_CS, B_CS);
+	CS_HIGH();
 	return 1;
 }
 
 uint8_t ArduCAM:: bus_read(int address)
 {
 	uint8_t value;
-	cbi(P_CS, B_CS);
+	CS_LOW();
 	#if defined (RASPBERRY_PI)
 		value = arducam_spi_read(address & 0x7F);
-		sbi(P_CS, B_CS);
-		return value;	
 	#else
-		#if (defined(ESP8266) || defined(__arm__) ||defined(TEENSYDUINO))
-		#if defined(OV5642_MINI_5MP)
-		  SPI.transfer(address);
-		  value = SPI.transfer(0x00);
+		bus->transfer(address);
+		value = bus->transfer(0x00);
+		#if (defined(ESP8266) || defined(__arm__) ||defined(TEENSYDUINO)) && defined(OV5642_MINI_5MP)
 		  // correction for bit rotation from readback
 		  value = (byte)(value >> 1) | (value << 7);
-		  // take the SS pin high to de-select the chip:
-		  sbi(P_CS, B_CS);
-		  return value;
-		#else
-		  SPI.transfer(address);
-		  value = SPI.transfer(0x00);
-		  // take the SS pin high to de-select the chip:
-		  sbi(P_CS, B_CS);
-		  return value;
-		#endif
-		#else
-		  SPI.transfer(address);
-		  value = SPI.transfer(0x00);
-		  // take the SS pin high to de-select the chip:
-		  sbi(P_CS, B_CS);
-		  return value;
 		#endif
-#endif
+	#endif
+	// take the SS pin high to de-select the chip:
+	CS_HIGH();
+	return value;
 }
 
 void ArduCAM:: OV3640_set_JPEG_size(uint8_t size)
@@ -885,42 +916,336 @@ void ArduCAM:: OV3640_set_JPEG_size(uint8_t size)
 #endif
 }
 
+// COM7 soft reset has no completion flag, and the ID reads the same before
+// and after it, so a good ID alone doesn't show the reset is over. Wait the
+// settle time first (what the Linux ov2640 driver allows), then poll the ID
+// so a missing or stuck sensor still shows up. Replaces a fixed 100 ms
+// sleep. Returns false on timeout.
+#define OV2640_RESET_SETTLE_MS 5
+
+bool ArduCAM::OV2640_wait_ready(uint16_t timeout_ms)
+{
+ #if (defined (OV2640_CAM)||defined (OV2640_MINI_2MP)||defined (OV2640_MINI_2MP_PLUS)) && !defined (RASPBERRY_PI)
+	uint32_t start = millis();
+	delay(OV2640_RESET_SETTLE_MS);
+	do
+	{
+		const uint8_t bank[2] = { 0xff, 0x01 };
+		if (sensor_write(bank, 2))
+		{
+			const uint8_t reg = OV2640_CHIPID_HIGH;
+			uint8_t pid = 0;
+			if (sensor_read(&reg, 1, &pid, 1) && pid == 0x26)
+				return true;
+		}
+		delayMicroseconds(200);
+	} while (millis() - start < timeout_ms);
+	return false;
+ #else
+	delay(timeout_ms);
+	return true;
+ #endif
+}
+
+// Registers the sensor changes itself (gain/exposure under AGC/AEC), that
+// trigger an action (resets) or are indirect: always written. The DSP's
+// indirect pairs (SDE 0x7c/0x7d, gamma 0x90/0x91, 0x92/0x93, matrix 0x96/0x97,
+// lens 0xa6/0xa7) auto-increment the address on every data write, so a
+// repeated value is a write to the next offset.
+static bool OV2640_volatile_reg(uint8_t bank, uint8_t reg)
+{
+	if (bank == 0)
+		return reg == 0x7c || reg == 0x7d || reg == 0xe0 ||
+		       (reg >= 0x90 && reg <= 0x93) || reg == 0x96 || reg == 0x97 ||
+		       reg == 0xa6 || reg == 0xa7;
+	return reg == 0x00 || reg == 0x04 || reg == 0x10 || reg == 0x45 || reg == 0x12;
+}
+
+void ArduCAM::OV2640_shadow_reset(void)
+{
+	memset(shadow_known, 0, sizeof(shadow_known));
+	shadow_bank = -1;
+	OV2640_window = NULL;
+	shadow_skipped = 0;
+	shadow_bus_writes = 0;
+	queue_head = queue_tail = 0;
+	queue_used = 0;
+	queue_group_head = queue_groups = 0;
+	queue_open = 0;
+	queue_bank = -1;
+	queue_recording = queue_overflow = false;
+	queue_write_us = 100; // ~3 bytes at 400 kHz plus overhead, refined by service_queue
+}
+
+bool ArduCAM::OV2640_select_bank(int8_t bank)
+{
+	if (bank < 0 || bank == shadow_bank)
+		return true;
+	shadow_bus_writes++;
+	if (!i2c_write8_8(0xff, bank))
+	{
+		shadow_bank = -1;
+		return false;
+	}
+	shadow_bank = bank;
+	return true;
+}
+
+byte ArduCAM::OV2640_shadow_write(uint8_t reg, uint8_t value)
+{
+	if (reg == 0xff)
+	{
+		int8_t bank = value & 0x01;
+		if (bank == shadow_bank)
+			shadow_skipped++;
+		return OV2640_select_bank(bank);
+	}
+
+	int8_t bank = shadow_bank;
+	if (bank < 0)
+	{
+		// Bank unknown (before the first select), can't attribute the write
+		shadow_bus_writes++;
+		return i2c_write8_8(reg, value);
+	}
+
+	uint8_t bit = 1 << (reg & 7);
+	bool known = shadow_known[bank][reg >> 3] & bit;
+	bool is_volatile = OV2640_volatile_reg(bank, reg);
+	if (!is_volatile && known && shadow_val[bank][reg] == value)
+	{
+		shadow_skipped++;
+		return 1;
+	}
+
+	if (!OV2640_select_bank(bank))
+		return 0;
+	shadow_bus_writes++;
+	if (!i2c_write8_8(reg, value))
+	{
+		shadow_known[bank][reg >> 3] &= ~bit;
+		return 0;
+	}
+	shadow_val[bank][reg] = value;
+	shadow_known[bank][reg >> 3] |= bit;
+
+	// COM7: a reset clears everything, a mode change reloads sensor defaults
+	if (bank == 1 && reg == 0x12)
+	{
+		memset(shadow_known[1], 0, sizeof(shadow_known[1]));
+		OV2640_window = NULL;
+		if (value & 0x80)
+		{
+			memset(shadow_known[0], 0, sizeof(shadow_known[0]));
+			shadow_bank = -1;
+		}
+	}
+	return 1;
+}
+
+bool ArduCAM::OV2640_shadow_value(uint8_t bank, uint8_t reg, uint8_t *value)
+{
+	if (bank > 1 || !(shadow_known[bank][reg >> 3] & (1 << (reg & 7))))
+		return false;
+	*value = shadow_val[bank][reg];
+	return true;
+}
+
 void ArduCAM::OV2640_set_JPEG_size(uint8_t size)
 {
  #if (defined (OV2640_CAM)||defined (OV2640_MINI_2MP)||defined (OV2640_MINI_2MP_PLUS))
-	switch(size)
+	if (size >= sizeof(OV2640_MODES) / sizeof(OV2640_MODES[0]))
+		size = OV2640_320x240;
+	const OV2640_mode &mode = OV2640_MODES[size];
+
+	// Same sensor timing already loaded: only the output scaler changes
+	if (mode.window != OV2640_window)
 	{
-		case OV2640_160x120:
-			wrSensorRegs8_8(OV2640_160x120_JPEG);
-			break;
-		case OV2640_176x144:
-			wrSensorRegs8_8(OV2640_176x144_JPEG);
-			break;
-		case OV2640_320x240:
-			wrSensorRegs8_8(OV2640_320x240_JPEG);
-			break;
-		case OV2640_352x288:
-	  	wrSensorRegs8_8(OV2640_352x288_JPEG);
-			break;
-		case OV2640_640x480:
-			wrSensorRegs8_8(OV2640_640x480_JPEG);
-			break;
-		case OV2640_800x600:
-			wrSensorRegs8_8(OV2640_800x600_JPEG);
-			break;
-		case OV2640_1024x768:
-			wrSensorRegs8_8(OV2640_1024x768_JPEG);
-			break;
-		case OV2640_1280x1024:
-			wrSensorRegs8_8(OV2640_1280x1024_JPEG);
-			break;
-		case OV2640_1600x1200:
-			wrSensorRegs8_8(OV2640_1600x1200_JPEG);
-			break;
-		default:
-			wrSensorRegs8_8(OV2640_320x240_JPEG);
+		wrSensorRegs8_8(mode.window, mode.window_len);
+		// Queued, the COM7 write clears the pointer again once it goes out
+		OV2640_window = queue_recording ? NULL : mode.window;
+	}
+	wrSensorReg8_8(0xff, 0x00);
+	wrSensorReg8_8(0xe0, 0x04); // Hold the DVP in reset while the scaler changes
+	wrSensorRegs8_8(mode.dsp, mode.dsp_len);
+	wrSensorRegs8_8(mode.delta, mode.delta_len);
+	wrSensorReg8_8(0xe0, 0x00);
+#endif
+}
+
+void ArduCAM::OV2640_set_window(uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                                uint16_t out_width, uint16_t out_height)
+{
+ #if (defined (OV2640_CAM)||defined (OV2640_MINI_2MP)||defined (OV2640_MINI_2MP_PLUS))
+	uint16_t hsize = width >> 2, vsize = height >> 2;
+	uint16_t zmow = out_width >> 2, zmoh = out_height >> 2;
+
+	wrSensorReg8_8(0xff, 0x00);
+	wrSensorReg8_8(0xe0, 0x04); // Hold the DVP in reset while the window changes
+	wrSensorReg8_8(0x51, hsize & 0xff);          // HSIZE
+	wrSensorReg8_8(0x52, vsize & 0xff);          // VSIZE
+	wrSensorReg8_8(0x53, x & 0xff);              // XOFFL
+	wrSensorReg8_8(0x54, y & 0xff);              // YOFFL
+	wrSensorReg8_8(0x55, ((vsize >> 1) & 0x80) | ((y >> 4) & 0x70) |
+	                     ((hsize >> 5) & 0x08) | ((x >> 8) & 0x07)); // VHYX
+	wrSensorReg8_8(0x57, (hsize >> 2) & 0x80);   // TEST, HSIZE[9]
+	wrSensorReg8_8(0x5a, zmow & 0xff);           // ZMOW
+	wrSensorReg8_8(0x5b, zmoh & 0xff);           // ZMOH
+	wrSensorReg8_8(0x5c, ((zmoh >> 6) & 0x04) | ((zmow >> 8) & 0x03)); // ZMHH
+	wrSensorReg8_8(0xe0, 0x00);
+#endif
+}
+
+void ArduCAM::OV2640_set_output_YUV422(bool yuv)
+{
+ #if (defined (OV2640_CAM)||defined (OV2640_MINI_2MP)||defined (OV2640_MINI_2MP_PLUS))
+	wrSensorReg8_8(0xff, 0x00);
+	wrSensorReg8_8(0xe0, 0x04);
+	wrSensorReg8_8(0xda, yuv ? 0x00 : 0x08); // IMAGE_MODE DVP format, as OV2640_QVGA_OUTPUT sets it
+	wrSensorReg8_8(0xe0, 0x00);
+#endif
+}
+
+byte ArduCAM::OV2640_write_bits(uint8_t bank, uint8_t reg, uint8_t mask, uint8_t value)
+{
+	uint8_t current = 0;
+	// A queued write is newer than anything the shadow or the sensor has
+	if (!(queue_recording && OV2640_queued_value(bank, reg, &current)) &&
+	    (OV2640_volatile_reg(bank, reg) || !OV2640_shadow_value(bank, reg, &current)))
+	{
+		OV2640_select_bank(bank); // Straight to the bus, even while recording
+		rdSensorReg8_8(reg, &current);
+	}
+	wrSensorReg8_8(0xff, bank);
+	return wrSensorReg8_8(reg, (current & ~mask) | (value & mask));
+}
+
+void ArduCAM::OV2640_begin_queue(void)
+{
+	queue_recording = true;
+	queue_overflow = false;
+	queue_open = 0;
+	if (queue_used == 0)
+		queue_bank = shadow_bank;
+	// Replay starts from a known bank whatever was sent in between
+	if (queue_bank >= 0)
+		wrSensorReg8_8(0xff, queue_bank);
+}
+
+bool ArduCAM::OV2640_end_queue(void (*done)(void))
+{
+	queue_recording = false;
+	if (queue_overflow || queue_groups >= sizeof(queue_group) / sizeof(queue_group[0]))
+	{
+		queue_open = 0;
+		queue_bank = -1; // The dropped writes may have selected a bank
+		return false;
+	}
+	uint8_t g = (queue_group_head + queue_groups) % (sizeof(queue_group) / sizeof(queue_group[0]));
+	queue_group[g].count = queue_open;
+	queue_group[g].done = done;
+	queue_groups++;
+	queue_tail += queue_open;
+	queue_used += queue_open;
+	queue_open = 0;
+	return true;
+}
+
+int ArduCAM::OV2640_service_queue(uint32_t budget_us)
+{
+	uint32_t start = micros();
+	int applied = 0;
+	while (queue_groups > 0)
+	{
+		uint8_t count = queue_group[queue_group_head].count;
+		if ((micros() - start) + (uint32_t)count * queue_write_us > budget_us)
 			break;
+
+		uint32_t group_start = micros();
+		for (uint8_t i = 0; i < count; i++)
+		{
+			wrSensorReg8_8(queue_reg[queue_head], queue_val[queue_head]);
+			queue_head++;
+		}
+		queue_used -= count;
+		if (count > 0)
+			queue_write_us = (3 * queue_write_us + (micros() - group_start) / count) / 4;
+
+		void (*done)(void) = queue_group[queue_group_head].done;
+		queue_group_head = (queue_group_head + 1) % (sizeof(queue_group) / sizeof(queue_group[0]));
+		queue_groups--;
+		applied++;
+		if (done)
+			done();
 	}
+	return applied;
+}
+
+// Latest recorded value, the open group included
+bool ArduCAM::OV2640_queued_value(uint8_t bank, uint8_t reg, uint8_t *value)
+{
+	bool found = false;
+	int8_t at_bank = -1;
+	for (uint16_t n = 0; n < queue_used + queue_open; n++)
+	{
+		uint8_t i = queue_head + n;
+		if (queue_reg[i] == 0xff)
+			at_bank = queue_val[i] & 0x01;
+		else if (at_bank == bank && queue_reg[i] == reg)
+		{
+			*value = queue_val[i];
+			found = true;
+		}
+	}
+	return found;
+}
+
+void ArduCAM::OV2640_set_auto_exposure(bool aec, bool agc)
+{
+ #if (defined (OV2640_CAM)||defined (OV2640_MINI_2MP)||defined (OV2640_MINI_2MP_PLUS))
+	OV2640_write_bits(1, 0x13, 0x05, (agc ? 0x04 : 0) | (aec ? 0x01 : 0)); // COM8
+#endif
+}
+
+void ArduCAM::OV2640_set_exposure(uint16_t lines)
+{
+ #if (defined (OV2640_CAM)||defined (OV2640_MINI_2MP)||defined (OV2640_MINI_2MP_PLUS))
+	OV2640_write_bits(1, 0x04, 0x03, lines);       // REG04, AEC[1:0]
+	wrSensorReg8_8(0x10, (lines >> 2) & 0xff);     // AEC[9:2]
+	OV2640_write_bits(1, 0x45, 0x3f, lines >> 10); // REG45, AEC[15:10]
+#endif
+}
+
+void ArduCAM::OV2640_set_gain(uint16_t gain_x16)
+{
+ #if (defined (OV2640_CAM)||defined (OV2640_MINI_2MP)||defined (OV2640_MINI_2MP_PLUS))
+	// Gain = (bit7 + 1)(bit6 + 1)(bit5 + 1)(bit4 + 1)(1 + bits[3:0] / 16)
+	uint8_t stages = 0;
+	if (gain_x16 < 16)
+		gain_x16 = 16;
+	while (gain_x16 >= 32 && stages < 4)
+	{
+		gain_x16 >>= 1;
+		stages++;
+	}
+	if (gain_x16 > 31)
+		gain_x16 = 31;
+	OV2640_write_bits(1, 0x45, 0xc0, 0);           // AGC[9:8]
+	wrSensorReg8_8(0x00, (((1 << stages) - 1) << 4) | (gain_x16 - 16)); // GAIN
+#endif
+}
+
+void ArduCAM::OV2640_set_AWB_lock(bool lock)
+{
+ #if (defined (OV2640_CAM)||defined (OV2640_MINI_2MP)||defined (OV2640_MINI_2MP_PLUS))
+	OV2640_write_bits(0, 0xc3, 0x08, lock ? 0 : 0x08); // CTRL1, AWB
+#endif
+}
+
+void ArduCAM::OV2640_set_clock_divider(uint8_t divider)
+{
+ #if (defined (OV2640_CAM)||defined (OV2640_MINI_2MP)||defined (OV2640_MINI_2MP_PLUS))
+	OV2640_write_bits(1, 0x11, 0x3f, divider); // CLKRC
 #endif
 }
 
@@ -2955,7 +3280,8 @@ int ArduCAM::wrSensorRegs8_8(const struct sensor_reg reglist[])
 	    reg_val = pgm_read_word(&next->val);
 	    err = wrSensorReg8_8(reg_addr, reg_val);
 	    next++;
-		#if (defined(ESP8266)||defined(ESP32)||defined(TEENSYDUINO))
+		// Teensy has no watchdog to feed, yielding per register only slows boot
+		#if (defined(ESP8266)||defined(ESP32))
 		    yield();
 		#endif
 	  }
@@ -2963,6 +3289,15 @@ int ArduCAM::wrSensorRegs8_8(const struct sensor_reg reglist[])
 	return 1;
 }
 
+int ArduCAM::wrSensorRegs8_8(const struct OV2640_reg *regs, uint8_t count)
+{
+ #if (defined (OV2640_CAM)||defined (OV2640_MINI_2MP)||defined (OV2640_MINI_2MP_PLUS))
+	for (uint8_t i = 0; i < count; i++)
+		wrSensorReg8_8(pgm_read_byte(&regs[i].reg), pgm_read_byte(&regs[i].val));
+ #endif
+	return 1;
+}
+
 	// Write 16 bit values to 8 bit register address
 int ArduCAM::wrSensorRegs8_16(const struct sensor_reg reglist[])
 {
@@ -2986,7 +3321,7 @@ int ArduCAM::wrSensorRegs8_16(const struct sensor_reg reglist[])
 	    //  if (!err)
 	    //return err;
 	    next++;
-		#if (defined(ESP8266)||defined(ESP32)||defined(TEENSYDUINO))
+		#if (defined(ESP8266)||defined(ESP32))
 			yield();
 		#endif
 	  }
@@ -3019,7 +3354,7 @@ int ArduCAM::wrSensorRegs16_8(const struct sensor_reg reglist[])
 	    //if (!err)
 	    //return err;
 	    next++;
-		#if (defined(ESP8266)||defined(ESP32)||defined(TEENSYDUINO))
+		#if (defined(ESP8266)||defined(ESP32))
 			yield();
 		#endif
 	  }
@@ -3045,7 +3380,7 @@ int ArduCAM::wrSensorRegs16_16(const struct sensor_reg reglist[])
 	    next++;
 	    reg_addr = pgm_read_word(&next->reg);
 	    reg_val = pgm_read_word(&next->val);
-			#if (defined(ESP8266)||defined(ESP32)||defined(TEENSYDUINO))
+			#if (defined(ESP8266)||defined(ESP32))
 			    yield();
 			#endif
 	  }
@@ -3057,35 +3392,71 @@ int ArduCAM::wrSensorRegs16_16(const struct sensor_reg reglist[])
 
 // Read/write 8 bit value to/from 8 bit register address	
 byte ArduCAM::wrSensorReg8_8(int regID, int regDat)
+{
+ #if (defined (OV2640_CAM)||defined (OV2640_MINI_2MP)||defined (OV2640_MINI_2MP_PLUS))
+	if (sensor_model == OV2640 && queue_recording)
+	{
+		if (queue_used + queue_open >= sizeof(queue_reg))
+		{
+			queue_overflow = true;
+			return 0;
+		}
+		uint8_t i = queue_tail + queue_open++;
+		queue_reg[i] = regID;
+		queue_val[i] = regDat;
+		if (regID == 0xff)
+			queue_bank = regDat & 0x01;
+		return 1;
+	}
+	if (sensor_model == OV2640)
+		return OV2640_shadow_write(regID, regDat);
+ #endif
+	return i2c_write8_8(regID, regDat);
+}
+
+#if !defined (RASPBERRY_PI)
+bool ArduCAM::sensor_write(const uint8_t *data, uint8_t length)
+{
+	return bus->i2c_write(sensor_addr >> 1, data, length) == 0;
+}
+
+// Register address, then a separate read (the SCCB has no repeated start)
+bool ArduCAM::sensor_read(const uint8_t *reg, uint8_t reg_length, uint8_t *data, uint8_t length)
+{
+	if (!sensor_write(reg, reg_length))
+		return false;
+	return bus->i2c_read(sensor_addr >> 1, data, length) == length;
+}
+#endif
+
+byte ArduCAM::i2c_write8_8(int regID, int regDat)
 {
 	#if defined (RASPBERRY_PI)
 		arducam_i2c_write( regID , regDat );
 	#else
-		Wire.beginTransmission(sensor_addr >> 1);
-	  Wire.write(regID & 0x00FF);
-	  Wire.write(regDat & 0x00FF);
-	  if (Wire.endTransmission())
+	  const uint8_t data[2] = { (uint8_t)regID, (uint8_t)regDat };
+	  if (!sensor_write(data, 2))
 	  {
 	    return 0;
 	  }
+	  // The OV2640 takes back to back SCCB writes, the 1 ms gap made table loads ~0.3 s
+	  #if !defined(TEENSYDUINO)
 	  delay(1);
+	  #endif
 	#endif
 	return 1;
 	
 }
+// Reads always go to the bus, AEC/AGC change registers behind our back
 byte ArduCAM::rdSensorReg8_8(uint8_t regID, uint8_t* regDat)
 {	
 	#if defined (RASPBERRY_PI) 
 		arducam_i2c_read(regID,regDat);
 	#else
-		Wire.beginTransmission(sensor_addr >> 1);
-	  Wire.write(regID & 0x00FF);
-	  Wire.endTransmission();
-	
-	  Wire.requestFrom((sensor_addr >> 1), 1);
-	  if (Wire.available())
-	    *regDat = Wire.read();
+	  sensor_read(&regID, 1, regDat, 1);
+	  #if !defined(TEENSYDUINO)
 	  delay(1);
+	  #endif
 	#endif
 	return 1;
 	
@@ -3096,12 +3467,8 @@ byte ArduCAM::wrSensorReg8_16(int regID, int regDat)
 	#if defined (RASPBERRY_PI) 
 		arducam_i2c_write16(regID, regDat );
 	#else
-		Wire.beginTransmission(sensor_addr >> 1);
-	  Wire.write(regID & 0x00FF);
-	
-	  Wire.write(regDat >> 8);            // sends data byte, MSB first
-	  Wire.write(regDat & 0x00FF);
-	  if (Wire.endTransmission())
+	  const uint8_t data[3] = { (uint8_t)regID, (uint8_t)(regDat >> 8), (uint8_t)regDat }; // data MSB first
+	  if (!sensor_write(data, 3))
 	  {
 	    return 0;
 	  }	
@@ -3114,17 +3481,9 @@ byte ArduCAM::rdSensorReg8_16(uint8_t regID, uint16_t* regDat)
 	#if defined (RASPBERRY_PI) 
   	arducam_i2c_read16(regID, regDat);
   #else
-  	uint8_t temp;
-	  Wire.beginTransmission(sensor_addr >> 1);
-	  Wire.write(regID);
-	  Wire.endTransmission();
-	
-	  Wire.requestFrom((sensor_addr >> 1), 2);
-	  if (Wire.available())
-	  {
-	    temp = Wire.read();
-	    *regDat = (temp << 8) | Wire.read();
-	  }
+  	uint8_t data[2];
+	  if (sensor_read(&regID, 1, data, 2))
+	    *regDat = (data[0] << 8) | data[1];
 	  delay(1);
 	#endif
   	return 1;
@@ -3137,11 +3496,8 @@ byte ArduCAM::wrSensorReg16_8(int regID, int regDat)
 		arducam_i2c_word_write(regID, regDat);
 		arducam_delay_ms(1);
 	#else
-		Wire.beginTransmission(sensor_addr >> 1);
-	  Wire.write(regID >> 8);            // sends instruction byte, MSB first
-	  Wire.write(regID & 0x00FF);
-	  Wire.write(regDat & 0x00FF);
-	  if (Wire.endTransmission())
+	  const uint8_t data[3] = { (uint8_t)(regID >> 8), (uint8_t)regID, (uint8_t)regDat }; // address MSB first
+	  if (!sensor_write(data, 3))
 	  {
 	    return 0;
 	  }
@@ -3154,15 +3510,8 @@ byte ArduCAM::rdSensorReg16_8(uint16_t regID, uint8_t* regDat)
 	#if defined (RASPBERRY_PI) 
 		arducam_i2c_word_read(regID, regDat );
 	#else
-		Wire.beginTransmission(sensor_addr >> 1);
-	  Wire.write(regID >> 8);
-	  Wire.write(regID & 0x00FF);
-	  Wire.endTransmission();
-	  Wire.requestFrom((sensor_addr >> 1), 1);
-	  if (Wire.available())
-	  {
-	    *regDat = Wire.read();
-	  }
+	  const uint8_t reg[2] = { (uint8_t)(regID >> 8), (uint8_t)regID };
+	  sensor_read(reg, 2, regDat, 1);
 	  delay(1);
 	#endif  
 	return 1;
@@ -3173,12 +3522,9 @@ byte ArduCAM::wrSensorReg16_16(int regID, int regDat)
 {
 	#if defined (RASPBERRY_PI)
 	#else
-	  Wire.beginTransmission(sensor_addr >> 1);
-	  Wire.write(regID >> 8);            // sends instruction byte, MSB first
-	  Wire.write(regID & 0x00FF);
-	  Wire.write(regDat >> 8);            // sends data byte, MSB first
-	  Wire.write(regDat & 0x00FF);
-	  if (Wire.endTransmission())
+	  const uint8_t data[4] = { (uint8_t)(regID >> 8), (uint8_t)regID,
+	                            (uint8_t)(regDat >> 8), (uint8_t)regDat }; // MSB first
+	  if (!sensor_write(data, 4))
 	  {
 	    return 0;
 	  }
@@ -3192,17 +3538,10 @@ byte ArduCAM::rdSensorReg16_16(uint16_t regID, uint16_t* regDat)
 {
 	#if defined (RASPBERRY_PI)
 	#else
-	  uint16_t temp;
-	  Wire.beginTransmission(sensor_addr >> 1);
-	  Wire.write(regID >> 8);
-	  Wire.write(regID & 0x00FF);
-	  Wire.endTransmission();
-	  Wire.requestFrom((sensor_addr >> 1), 2);
-	  if (Wire.available())
-	  {
-	    temp = Wire.read();
-	    *regDat = (temp << 8) | Wire.read();
-	  }
+	  const uint8_t reg[2] = { (uint8_t)(regID >> 8), (uint8_t)regID };
+	  uint8_t data[2];
+	  if (sensor_read(reg, 2, data, 2))
+	    *regDat = (data[0] << 8) | data[1];
 	  delay(1);
 	#endif 
   return (1);
@@ -631,12 +631,30 @@ struct sensor_reg {
 	uint16_t reg;
 	uint16_t val;
 };
+struct OV2640_reg;
 
 
 
 /****************************************************************/
 /* define a structure for sensor register initialization values */
 /****************************************************************/
+/* Bus I/O                                                      */
+/****************************************************************/
+
+// Everything the driver sends over SPI (ArduChip registers and FIFO) and I2C
+// (sensor registers) goes through one of these. ArduCAM_hardware drives SPI,
+// Wire and the CS pin; set_transport() swaps in another, e.g. a simulated
+// camera for a host build. Raspberry Pi builds keep their arducam_* calls.
+struct ArduCAM_transport
+{
+	void (*select)(bool selected);  // NULL = the CS pin given to the constructor
+	uint8_t (*transfer)(uint8_t data);
+	void (*transfers)(uint8_t *buf, uint32_t size);
+	// 7-bit address. Write returns 0 when acked (as Wire.endTransmission), read the bytes received
+	uint8_t (*i2c_write)(uint8_t addr, const uint8_t *data, uint8_t length);
+	uint8_t (*i2c_read)(uint8_t addr, uint8_t *data, uint8_t length);
+};
+extern const ArduCAM_transport ArduCAM_hardware;
 
 class ArduCAM 
 {
@@ -644,6 +662,7 @@ class ArduCAM
 	ArduCAM( void );
 	ArduCAM(byte model ,int CS);
 	void InitCAM( void );
+	void set_transport(const ArduCAM_transport *transport) { bus = transport; }
 	
 	void CS_HIGH(void);
 	void CS_LOW(void);
@@ -669,6 +688,7 @@ class ArduCAM
  
 	// Write 8 bit values to 8 bit register address
 	int wrSensorRegs8_8(const struct sensor_reg*);
+	int wrSensorRegs8_8(const struct OV2640_reg*, uint8_t count);
 	
 	// Write 16 bit values to 8 bit register address
 	int wrSensorRegs8_16(const struct sensor_reg*);
@@ -696,6 +716,41 @@ class ArduCAM
 	byte rdSensorReg16_16(uint16_t regID, uint16_t* regDat);
 
 	void OV2640_set_JPEG_size(uint8_t size);
+	// Crop the DSP input (x, y, width, height) and scale it to out_width x out_height.
+	// Sizes are multiples of 4, the full window is restored by OV2640_set_JPEG_size.
+	void OV2640_set_window(uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+	                       uint16_t out_width, uint16_t out_height);
+	// DVP output for the BMP path, RGB565 (high byte first) or YUV422 (Y U Y V)
+	void OV2640_set_output_YUV422(bool yuv);
+	bool OV2640_wait_ready(uint16_t timeout_ms);
+	// Manual sensor control. Exposure is in sensor line periods, gain in 1/16
+	// steps (16 = 1x, up to 496 = 31x); both are overridden while AEC/AGC run.
+	// Exposure longer than the frame stretches the frame.
+	void OV2640_set_auto_exposure(bool aec, bool agc);
+	void OV2640_set_exposure(uint16_t lines);
+	void OV2640_set_gain(uint16_t gain_x16);
+	// Stops the AWB calculation, the white balance gains stay where they are
+	void OV2640_set_AWB_lock(bool lock);
+	// CLKRC: sensor clock = XVCLK / (divider + 1), the frame period scales with it
+	void OV2640_set_clock_divider(uint8_t divider);
+
+	// OV2640 register shadow. Both banks are mirrored by wrSensorReg8_8, so bank
+	// selects and writes that wouldn't change anything never reach the bus.
+	void OV2640_shadow_reset(void);
+	// Last value written, false if the register hasn't been written since reset
+	bool OV2640_shadow_value(uint8_t bank, uint8_t reg, uint8_t *value);
+	uint32_t shadow_skipped;     // Writes avoided
+	uint32_t shadow_bus_writes;  // Writes that went out, bank selects included
+
+	// Deferred OV2640 writes. Between begin_queue and end_queue wrSensorReg8_8
+	// only records, in order; end_queue closes the group (false if it didn't
+	// fit and was dropped). service_queue sends whole groups, oldest first,
+	// while they fit in budget_us, and calls done() after each one.
+	void OV2640_begin_queue(void);
+	bool OV2640_end_queue(void (*done)(void));
+	int OV2640_service_queue(uint32_t budget_us);
+	uint8_t OV2640_queued_groups(void) { return queue_groups; }
+	uint16_t queue_write_us;     // Measured cost of one write, sizes the budget
 	void OV3640_set_JPEG_size(uint8_t size);
 	void OV5642_set_JPEG_size(uint8_t size);
 	void OV5640_set_JPEG_size(uint8_t size);
@@ -752,10 +807,9 @@ class ArduCAM
 	
 	void set_format(byte fmt);
 	
-	#if defined (RASPBERRY_PI)
-    uint8_t transfer(uint8_t data);
+	// Raw SPI, for reading the FIFO after set_fifo_burst()
+	uint8_t transfer(uint8_t data);
 	void transfers(uint8_t *buf, uint32_t size);
-    #endif
 
 	void transferBytes_(uint8_t * out, uint8_t * in, uint8_t size);
 	void transferBytes(uint8_t * out, uint8_t * in, uint32_t size);
@@ -767,6 +821,36 @@ class ArduCAM
 	byte m_fmt;
 	byte sensor_model;
 	byte sensor_addr;
+	const ArduCAM_transport *bus;
+
+	// Sensor register access over the transport: true when acked / fully read
+	bool sensor_write(const uint8_t *data, uint8_t length);
+	bool sensor_read(const uint8_t *reg, uint8_t reg_length, uint8_t *data, uint8_t length);
+	byte i2c_write8_8(int regID, int regDat);
+	byte OV2640_shadow_write(uint8_t reg, uint8_t value);
+	// Read-modify-write, the sensor is read when the shadow can't be trusted
+	byte OV2640_write_bits(uint8_t bank, uint8_t reg, uint8_t mask, uint8_t value);
+	bool OV2640_select_bank(int8_t bank);
+	uint8_t shadow_val[2][256];
+	uint8_t shadow_known[2][32];  // Bit per register
+	int8_t shadow_bank;           // Selected on the sensor, -1 = unknown
+	const OV2640_reg *OV2640_window; // Sensor timing in place, null after COM7 changes
+
+	// Write queue: register/value pairs in a ring (uint8_t indices wrap at 256),
+	// groups in a ring of their own
+	bool OV2640_queued_value(uint8_t bank, uint8_t reg, uint8_t *value);
+	uint8_t queue_reg[256];
+	uint8_t queue_val[256];
+	uint8_t queue_head, queue_tail;
+	uint16_t queue_used;
+	struct {
+		uint8_t count;
+		void (*done)(void);
+	} queue_group[16];
+	uint8_t queue_group_head, queue_groups;
+	uint16_t queue_open;          // Entries in the group being recorded
+	int8_t queue_bank;            // Bank as of the last recorded write
+	bool queue_recording, queue_overflow;
 };
 
 #if defined OV7660_CAM	
@@ -795,6 +879,7 @@ class ArduCAM
 
 #if (defined(OV2640_CAM) || defined(OV2640_MINI_2MP) || defined(OV2640_MINI_2MP_PLUS))
 	#include "ov2640_regs.h"
+	#include "ov2640_modes.h"
 #endif
 
 #if defined MT9D111A_CAM  || defined MT9D111B_CAM 	
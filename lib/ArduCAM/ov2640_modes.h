@@ -0,0 +1,194 @@
+#ifndef OV2640_MODES_H
+#define OV2640_MODES_H
+
+// OV2640 output sizes as 2-byte entries, replacing the ArduCAM
+// OV2640_*_JPEG tables (4 bytes per entry, mostly the same). Every size is a sensor window (CIF or UXGA timing) plus DSP
+// settings shared by that window plus a few scaling registers of its own.
+// OV2640_set_JPEG_size() writes the window only when it changes, so
+// switching between sizes of the same family costs a handful of writes.
+
+struct OV2640_reg {
+	uint8_t reg;
+	uint8_t val;
+};
+static_assert(sizeof(OV2640_reg) == 2, "OV2640_reg must stay 2 bytes");
+
+// CIF sensor timing, shared by 160x120 to 352x288
+constexpr OV2640_reg OV2640_CIF_WINDOW[] PROGMEM = {
+	{ 0xff, 0x01 }, { 0x12, 0x40 }, { 0x17, 0x11 }, { 0x18, 0x43 }, { 0x19, 0x00 }, { 0x1a, 0x4b },
+	{ 0x32, 0x09 }, { 0x4f, 0xca }, { 0x50, 0xa8 }, { 0x5a, 0x23 }, { 0x6d, 0x00 }, { 0x39, 0x12 },
+	{ 0x35, 0xda }, { 0x22, 0x1a }, { 0x37, 0xc3 }, { 0x23, 0x00 }, { 0x34, 0xc0 }, { 0x36, 0x1a },
+	{ 0x06, 0x88 }, { 0x07, 0xc0 }, { 0x0d, 0x87 }, { 0x0e, 0x41 }, { 0x4c, 0x00 },
+};
+
+// DSP settings common to every CIF mode
+constexpr OV2640_reg OV2640_CIF_DSP[] PROGMEM = {
+	{ 0xc0, 0x64 }, { 0xc1, 0x4b }, { 0x86, 0x35 }, { 0x51, 0xc8 }, { 0x52, 0x96 }, { 0x53, 0x00 },
+	{ 0x54, 0x00 }, { 0x55, 0x00 }, { 0x57, 0x00 }, { 0x5c, 0x00 },
+};
+
+// 160x120 output scaling
+constexpr OV2640_reg OV2640_160x120_DELTA[] PROGMEM = {
+	{ 0x50, 0x92 }, { 0x5a, 0x28 }, { 0x5b, 0x1e },
+};
+
+// 176x144 output scaling
+constexpr OV2640_reg OV2640_176x144_DELTA[] PROGMEM = {
+	{ 0x50, 0x92 }, { 0x5a, 0x2c }, { 0x5b, 0x24 },
+};
+
+// 320x240 output scaling
+constexpr OV2640_reg OV2640_320x240_DELTA[] PROGMEM = {
+	{ 0x50, 0x89 }, { 0x5a, 0x50 }, { 0x5b, 0x3c },
+};
+
+// 352x288 output scaling
+constexpr OV2640_reg OV2640_352x288_DELTA[] PROGMEM = {
+	{ 0x50, 0x89 }, { 0x5a, 0x58 }, { 0x5b, 0x48 },
+};
+
+// UXGA sensor timing, shared by 640x480 to 1600x1200
+constexpr OV2640_reg OV2640_UXGA_WINDOW[] PROGMEM = {
+	{ 0xff, 0x01 }, { 0x11, 0x01 }, { 0x12, 0x00 }, { 0x17, 0x11 }, { 0x18, 0x75 }, { 0x32, 0x36 },
+	{ 0x19, 0x01 }, { 0x1a, 0x97 }, { 0x03, 0x0f }, { 0x37, 0x40 }, { 0x4f, 0xbb }, { 0x50, 0x9c },
+	{ 0x5a, 0x57 }, { 0x6d, 0x80 }, { 0x3d, 0x34 }, { 0x39, 0x02 }, { 0x35, 0x88 }, { 0x22, 0x0a },
+	{ 0x37, 0x40 }, { 0x34, 0xa0 }, { 0x06, 0x02 }, { 0x0d, 0xb7 }, { 0x0e, 0x01 },
+};
+
+// DSP settings common to every UXGA mode
+constexpr OV2640_reg OV2640_UXGA_DSP[] PROGMEM = {
+	{ 0xc0, 0xc8 }, { 0xc1, 0x96 }, { 0x51, 0x90 }, { 0x52, 0x2c }, { 0x53, 0x00 }, { 0x54, 0x00 },
+	{ 0x55, 0x88 },
+};
+
+// 640x480 output scaling
+constexpr OV2640_reg OV2640_640x480_DELTA[] PROGMEM = {
+	{ 0x86, 0x3d }, { 0x50, 0x89 }, { 0x57, 0x00 }, { 0x5a, 0xa0 }, { 0x5b, 0x78 }, { 0x5c, 0x00 },
+	{ 0xd3, 0x04 },
+};
+
+// 800x600 output scaling
+constexpr OV2640_reg OV2640_800x600_DELTA[] PROGMEM = {
+	{ 0x86, 0x35 }, { 0x50, 0x89 }, { 0x57, 0x00 }, { 0x5a, 0xc8 }, { 0x5b, 0x96 }, { 0x5c, 0x00 },
+	{ 0xd3, 0x02 },
+};
+
+// 1024x768 output scaling
+constexpr OV2640_reg OV2640_1024x768_DELTA[] PROGMEM = {
+	{ 0x8c, 0x00 }, { 0x86, 0x3d }, { 0x50, 0x00 }, { 0x5a, 0x00 }, { 0x5b, 0xc0 }, { 0x5c, 0x01 },
+	{ 0xd3, 0x02 },
+};
+
+// 1280x1024 output scaling
+constexpr OV2640_reg OV2640_1280x1024_DELTA[] PROGMEM = {
+	{ 0x86, 0x3d }, { 0x50, 0x00 }, { 0x57, 0x00 }, { 0x5a, 0x40 }, { 0x5b, 0xf0 }, { 0x5c, 0x01 },
+	{ 0xd3, 0x02 },
+};
+
+// 1600x1200 output scaling
+constexpr OV2640_reg OV2640_1600x1200_DELTA[] PROGMEM = {
+	{ 0x86, 0x3d }, { 0x50, 0x00 }, { 0x57, 0x00 }, { 0x5a, 0x90 }, { 0x5b, 0x2c }, { 0x5c, 0x05 },
+	{ 0xd3, 0x02 },
+};
+
+struct OV2640_mode {
+	const OV2640_reg *window;
+	uint8_t window_len;
+	const OV2640_reg *dsp;
+	uint8_t dsp_len;
+	const OV2640_reg *delta;
+	uint8_t delta_len;
+};
+
+#define OV2640_TABLE(t) t, sizeof(t) / sizeof(t[0])
+
+// Indexed by OV2640_160x120 ... OV2640_1600x1200
+constexpr OV2640_mode OV2640_MODES[] = {
+	{ OV2640_TABLE(OV2640_CIF_WINDOW), OV2640_TABLE(OV2640_CIF_DSP), OV2640_TABLE(OV2640_160x120_DELTA) },
+	{ OV2640_TABLE(OV2640_CIF_WINDOW), OV2640_TABLE(OV2640_CIF_DSP), OV2640_TABLE(OV2640_176x144_DELTA) },
+	{ OV2640_TABLE(OV2640_CIF_WINDOW), OV2640_TABLE(OV2640_CIF_DSP), OV2640_TABLE(OV2640_320x240_DELTA) },
+	{ OV2640_TABLE(OV2640_CIF_WINDOW), OV2640_TABLE(OV2640_CIF_DSP), OV2640_TABLE(OV2640_352x288_DELTA) },
+	{ OV2640_TABLE(OV2640_UXGA_WINDOW), OV2640_TABLE(OV2640_UXGA_DSP), OV2640_TABLE(OV2640_640x480_DELTA) },
+	{ OV2640_TABLE(OV2640_UXGA_WINDOW), OV2640_TABLE(OV2640_UXGA_DSP), OV2640_TABLE(OV2640_800x600_DELTA) },
+	{ OV2640_TABLE(OV2640_UXGA_WINDOW), OV2640_TABLE(OV2640_UXGA_DSP), OV2640_TABLE(OV2640_1024x768_DELTA) },
+	{ OV2640_TABLE(OV2640_UXGA_WINDOW), OV2640_TABLE(OV2640_UXGA_DSP), OV2640_TABLE(OV2640_1280x1024_DELTA) },
+	{ OV2640_TABLE(OV2640_UXGA_WINDOW), OV2640_TABLE(OV2640_UXGA_DSP), OV2640_TABLE(OV2640_1600x1200_DELTA) },
+};
+
+// Boot register setup in the same 2-byte form, replacing the 4-byte
+// OV2640_QVGA and OV2640_JPEG_INIT tables. Each is its own sensor setup, the
+// DSP setup both share, then its own output tail, written in that order.
+// QVGA (BMP boot) sensor setup
+constexpr OV2640_reg OV2640_QVGA_SENSOR[] PROGMEM = {
+	{ 0xff, 0x00 }, { 0x2c, 0xff }, { 0x2e, 0xdf }, { 0xff, 0x01 }, { 0x3c, 0x32 }, { 0x11, 0x00 },
+	{ 0x09, 0x02 }, { 0x04, 0xa8 }, { 0x13, 0xe5 }, { 0x14, 0x48 }, { 0x2c, 0x0c }, { 0x33, 0x78 },
+	{ 0x3a, 0x33 }, { 0x3b, 0xfb }, { 0x3e, 0x00 }, { 0x43, 0x11 }, { 0x16, 0x10 }, { 0x39, 0x02 },
+	{ 0x35, 0x88 }, { 0x22, 0x0a }, { 0x37, 0x40 }, { 0x23, 0x00 }, { 0x34, 0xa0 }, { 0x06, 0x02 },
+	{ 0x06, 0x88 }, { 0x07, 0xc0 }, { 0x0d, 0xb7 }, { 0x0e, 0x01 }, { 0x4c, 0x00 }, { 0x4a, 0x81 },
+	{ 0x21, 0x99 }, { 0x24, 0x40 }, { 0x25, 0x38 }, { 0x26, 0x82 }, { 0x5c, 0x00 }, { 0x63, 0x00 },
+	{ 0x46, 0x22 }, { 0x0c, 0x3a }, { 0x5d, 0x55 }, { 0x5e, 0x7d }, { 0x5f, 0x7d }, { 0x60, 0x55 },
+	{ 0x61, 0x70 }, { 0x62, 0x80 }, { 0x7c, 0x05 }, { 0x20, 0x80 }, { 0x28, 0x30 }, { 0x6c, 0x00 },
+	{ 0x6d, 0x80 }, { 0x6e, 0x00 }, { 0x70, 0x02 }, { 0x71, 0x94 }, { 0x73, 0xc1 }, { 0x3d, 0x34 },
+	{ 0x12, 0x04 }, { 0x5a, 0x57 }, { 0x4f, 0xbb }, { 0x50, 0x9c },
+};
+
+// JPEG boot sensor setup, CIF timing
+constexpr OV2640_reg OV2640_JPEG_SENSOR[] PROGMEM = {
+	{ 0xff, 0x00 }, { 0x2c, 0xff }, { 0x2e, 0xdf }, { 0xff, 0x01 }, { 0x3c, 0x32 }, { 0x11, 0x00 },
+	{ 0x09, 0x02 }, { 0x04, 0x28 }, { 0x13, 0xe5 }, { 0x14, 0x48 }, { 0x2c, 0x0c }, { 0x33, 0x78 },
+	{ 0x3a, 0x33 }, { 0x3b, 0xfb }, { 0x3e, 0x00 }, { 0x43, 0x11 }, { 0x16, 0x10 }, { 0x39, 0x92 },
+	{ 0x35, 0xda }, { 0x22, 0x1a }, { 0x37, 0xc3 }, { 0x23, 0x00 }, { 0x34, 0xc0 }, { 0x36, 0x1a },
+	{ 0x06, 0x88 }, { 0x07, 0xc0 }, { 0x0d, 0x87 }, { 0x0e, 0x41 }, { 0x4c, 0x00 }, { 0x48, 0x00 },
+	{ 0x5b, 0x00 }, { 0x42, 0x03 }, { 0x4a, 0x81 }, { 0x21, 0x99 }, { 0x24, 0x40 }, { 0x25, 0x38 },
+	{ 0x26, 0x82 }, { 0x5c, 0x00 }, { 0x63, 0x00 }, { 0x61, 0x70 }, { 0x62, 0x80 }, { 0x7c, 0x05 },
+	{ 0x20, 0x80 }, { 0x28, 0x30 }, { 0x6c, 0x00 }, { 0x6d, 0x80 }, { 0x6e, 0x00 }, { 0x70, 0x02 },
+	{ 0x71, 0x94 }, { 0x73, 0xc1 }, { 0x12, 0x40 }, { 0x17, 0x11 }, { 0x18, 0x43 }, { 0x19, 0x00 },
+	{ 0x1a, 0x4b }, { 0x32, 0x09 }, { 0x37, 0xc0 }, { 0x4f, 0x60 }, { 0x50, 0xa8 }, { 0x6d, 0x00 },
+	{ 0x3d, 0x38 }, { 0x46, 0x3f }, { 0x4f, 0x60 }, { 0x0c, 0x3c },
+};
+
+// DSP setup shared by both, written in this order (0x7c/0x7d, 0x90-0x97 and
+// 0xa6/0xa7 are address/data pairs)
+constexpr OV2640_reg OV2640_INIT_DSP[] PROGMEM = {
+	{ 0xff, 0x00 }, { 0xe5, 0x7f }, { 0xf9, 0xc0 }, { 0x41, 0x24 }, { 0xe0, 0x14 }, { 0x76, 0xff },
+	{ 0x33, 0xa0 }, { 0x42, 0x20 }, { 0x43, 0x18 }, { 0x4c, 0x00 }, { 0x87, 0xd0 }, { 0x88, 0x3f },
+	{ 0xd7, 0x03 }, { 0xd9, 0x10 }, { 0xd3, 0x82 }, { 0xc8, 0x08 }, { 0xc9, 0x80 }, { 0x7c, 0x00 },
+	{ 0x7d, 0x00 }, { 0x7c, 0x03 }, { 0x7d, 0x48 }, { 0x7d, 0x48 }, { 0x7c, 0x08 }, { 0x7d, 0x20 },
+	{ 0x7d, 0x10 }, { 0x7d, 0x0e }, { 0x90, 0x00 }, { 0x91, 0x0e }, { 0x91, 0x1a }, { 0x91, 0x31 },
+	{ 0x91, 0x5a }, { 0x91, 0x69 }, { 0x91, 0x75 }, { 0x91, 0x7e }, { 0x91, 0x88 }, { 0x91, 0x8f },
+	{ 0x91, 0x96 }, { 0x91, 0xa3 }, { 0x91, 0xaf }, { 0x91, 0xc4 }, { 0x91, 0xd7 }, { 0x91, 0xe8 },
+	{ 0x91, 0x20 }, { 0x92, 0x00 }, { 0x93, 0x06 }, { 0x93, 0xe3 }, { 0x93, 0x03 }, { 0x93, 0x03 },
+	{ 0x93, 0x00 }, { 0x93, 0x02 }, { 0x93, 0x00 }, { 0x93, 0x00 }, { 0x93, 0x00 }, { 0x93, 0x00 },
+	{ 0x93, 0x00 }, { 0x93, 0x00 }, { 0x93, 0x00 }, { 0x96, 0x00 }, { 0x97, 0x08 }, { 0x97, 0x19 },
+	{ 0x97, 0x02 }, { 0x97, 0x0c }, { 0x97, 0x24 }, { 0x97, 0x30 }, { 0x97, 0x28 }, { 0x97, 0x26 },
+	{ 0x97, 0x02 }, { 0x97, 0x98 }, { 0x97, 0x80 }, { 0x97, 0x00 }, { 0x97, 0x00 }, { 0xa4, 0x00 },
+	{ 0xa8, 0x00 }, { 0xc5, 0x11 }, { 0xc6, 0x51 }, { 0xbf, 0x80 }, { 0xc7, 0x10 }, { 0xb6, 0x66 },
+	{ 0xb8, 0xa5 }, { 0xb7, 0x64 }, { 0xb9, 0x7c }, { 0xb3, 0xaf }, { 0xb4, 0x97 }, { 0xb5, 0xff },
+	{ 0xb0, 0xc5 }, { 0xb1, 0x94 }, { 0xb2, 0x0f }, { 0xc4, 0x5c },
+};
+
+// QVGA lens/gamma tail, 320x240 output and DVP format
+constexpr OV2640_reg OV2640_QVGA_OUTPUT[] PROGMEM = {
+	{ 0xa6, 0x00 }, { 0xa7, 0x20 }, { 0xa7, 0xd8 }, { 0xa7, 0x1b }, { 0xa7, 0x31 }, { 0xa7, 0x00 },
+	{ 0xa7, 0x18 }, { 0xa7, 0x20 }, { 0xa7, 0xd8 }, { 0xa7, 0x19 }, { 0xa7, 0x31 }, { 0xa7, 0x00 },
+	{ 0xa7, 0x18 }, { 0xa7, 0x20 }, { 0xa7, 0xd8 }, { 0xa7, 0x19 }, { 0xa7, 0x31 }, { 0xa7, 0x00 },
+	{ 0xa7, 0x18 }, { 0x7f, 0x00 }, { 0xe5, 0x1f }, { 0xe1, 0x77 }, { 0xdd, 0x7f }, { 0xc2, 0x0e },
+	{ 0xff, 0x00 }, { 0xe0, 0x04 }, { 0xc0, 0xc8 }, { 0xc1, 0x96 }, { 0x86, 0x3d }, { 0x51, 0x90 },
+	{ 0x52, 0x2c }, { 0x53, 0x00 }, { 0x54, 0x00 }, { 0x55, 0x88 }, { 0x57, 0x00 }, { 0x50, 0x92 },
+	{ 0x5a, 0x50 }, { 0x5b, 0x3c }, { 0x5c, 0x00 }, { 0xd3, 0x04 }, { 0xe0, 0x00 }, { 0xff, 0x00 },
+	{ 0x05, 0x00 }, { 0xda, 0x08 }, { 0xd7, 0x03 }, { 0xe0, 0x00 }, { 0x05, 0x00 },
+};
+
+// JPEG: the DSP values it sets differently, then 176x144 output
+constexpr OV2640_reg OV2640_JPEG_OUTPUT[] PROGMEM = {
+	{ 0x87, 0xd5 }, { 0x92, 0x00 }, { 0x93, 0x06 }, { 0x93, 0xe3 }, { 0x93, 0x05 }, { 0x93, 0x05 },
+	{ 0x93, 0x00 }, { 0x93, 0x04 }, { 0xc3, 0xed }, { 0xc0, 0x64 }, { 0xc1, 0x4b }, { 0x8c, 0x00 },
+	{ 0x86, 0x3d }, { 0x50, 0x00 }, { 0x51, 0xc8 }, { 0x52, 0x96 }, { 0x53, 0x00 }, { 0x54, 0x00 },
+	{ 0x55, 0x00 }, { 0x5a, 0xc8 }, { 0x5b, 0x96 }, { 0x5c, 0x00 }, { 0xd3, 0x00 }, { 0xd3, 0x7f },
+	{ 0xc3, 0xed }, { 0x7f, 0x00 }, { 0xda, 0x00 }, { 0xe5, 0x1f }, { 0xe1, 0x67 }, { 0xe0, 0x00 },
+	{ 0xdd, 0x7f }, { 0x05, 0x00 }, { 0x12, 0x40 }, { 0xd3, 0x04 }, { 0xd3, 0x7f }, { 0xc0, 0x16 },
+	{ 0xc1, 0x12 }, { 0x8c, 0x00 }, { 0x86, 0x3d }, { 0x50, 0x00 }, { 0x51, 0x2c }, { 0x52, 0x24 },
+	{ 0x53, 0x00 }, { 0x54, 0x00 }, { 0x55, 0x00 }, { 0x5a, 0x2c }, { 0x5b, 0x24 }, { 0x5c, 0x00 },
+};
+
+#endif
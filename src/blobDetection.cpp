@@ -8,6 +8,16 @@ int lastCentroidY = -1;
 int tempID = 0;
 float circleThreshold = 10;
 int blobThreshold = 25;
+int blobMinPixels = 4; // Smaller blobs are dropped as noise
+uint32_t labelStack[labelStackSize];
+
+// Alpha-beta filter gains for the motion estimate
+const float motionAlpha = 0.6f;
+const float motionBeta = 0.3f;
+// Gaps longer than this restart the estimate instead of producing a huge velocity
+const uint32_t motionMaxGap = 250000;
+// Never extrapolate further ahead than this
+const uint32_t maxPrediction = 100000;
 
 Pixel trackBlob(const std::vector<Blob> &blobs, int blobThreshold, TrackerState &state) {
     if (!blobs.empty()) {
@@ -35,6 +45,7 @@ Pixel trackBlob(const std::vector<Blob> &blobs, int blobThreshold, TrackerState
             });
         state.lastCentroidX = std::round(largest.centreX);
         state.lastCentroidY = std::round(largest.centreY);
+        resetTargetMotion(state); // Different target, old velocity no longer applies
         return { state.lastCentroidX, state.lastCentroidY };
     }
 
@@ -44,10 +55,54 @@ Pixel trackBlob(const std::vector<Blob> &blobs, int blobThreshold, TrackerState
     return { -1, -1 };
 }
 
-void setCurrentTarget(std::vector<Blob> &blobs, bool &targetSet, TrackerState &state) {
+void resetTargetMotion(TrackerState &state) {
+    state.motionValid = false;
+    state.velX = state.velY = 0;
+}
+
+void updateTargetMotion(TrackerState &state, float x, float y, uint32_t timestamp) {
+    uint32_t gap = timestamp - state.lastTimestamp;
+    if (!state.motionValid || gap == 0 || gap > motionMaxGap) {
+        state.posX = x;
+        state.posY = y;
+        state.velX = state.velY = 0;
+        state.lastTimestamp = timestamp;
+        state.motionValid = true;
+        return;
+    }
+
+    // Predict to this frame, then correct with the measured residual
+    float dt = gap * 1e-6f;
+    float predX = state.posX + state.velX * dt;
+    float predY = state.posY + state.velY * dt;
+    float residualX = x - predX;
+    float residualY = y - predY;
+
+    state.posX = predX + motionAlpha * residualX;
+    state.posY = predY + motionAlpha * residualY;
+    state.velX += (motionBeta / dt) * residualX;
+    state.velY += (motionBeta / dt) * residualY;
+    state.lastTimestamp = timestamp;
+}
+
+void predictTarget(const TrackerState &state, uint32_t atTime, float &x, float &y) {
+    if (!state.motionValid) {
+        x = state.posX;
+        y = state.posY;
+        return;
+    }
+    uint32_t ahead = atTime - state.lastTimestamp;
+    if (ahead > maxPrediction) ahead = maxPrediction;
+
+    float dt = ahead * 1e-6f;
+    x = state.posX + state.velX * dt;
+    y = state.posY + state.velY * dt;
+}
+
+void setCurrentTarget(std::vector<Blob> &blobs, int minPixels, bool &targetSet, TrackerState &state) {
     targetSet = false;
     for (Blob &target : blobs) {
-        if (target.pixelCount > 3 &&
+        if (target.pixelCount > minPixels &&
             target.sumY != 0 && target.sumX != 0) {
 
             targetSet = true;
@@ -59,69 +114,8 @@ void setCurrentTarget(std::vector<Blob> &blobs, bool &targetSet, TrackerState &s
     }
 }
 
-
-void detectBlobs(int pixelHeight, int pixelWidth, uint8_t mask[], std::vector<Blob> &blobs) {
-    blobs.clear();
-    std::vector<Pixel> queue; // DFS stack
-    queue.reserve(pixelWidth * pixelHeight);
-
-    for (int y = 0; y < pixelHeight; y++) {
-        for (int x = 0; x < pixelWidth; x++) {
-            if (getPixelMask(x, y, mask, pixelWidth)) {
-                // Start Blob
-                tempID += 1;
-                Blob blob;
-                blob.id = tempID;
-                blob.minX = blob.maxX = x;
-                blob.minY = blob.maxY = y;
-                blob.sumX = blob.sumY = 0;
-                blob.pixelCount = 0;
-
-                queue.clear();
-                queue.push_back({x, y});
-                clearPixelMask(x, y, mask, pixelWidth);
-
-                while (!queue.empty()) {
-                    Pixel p = queue.back();
-                    queue.pop_back();
-
-                    // Update blob statistics
-                    blob.sumX += p.x;
-                    blob.sumY += p.y;
-                    blob.pixelCount++;
-                    if (p.x < blob.minX) blob.minX = p.x;
-                    if (p.x > blob.maxX) blob.maxX = p.x;
-                    if (p.y < blob.minY) blob.minY = p.y;
-                    if (p.y > blob.maxY) blob.maxY = p.y;
-
-                    // Check 8-connected neighbors
-                    for (int dy = -1; dy <= 1; dy++) {
-                        for (int dx = -1; dx <= 1; dx++) {
-                            if (dx == 0 && dy == 0) continue;
-                            int nx = p.x + dx;
-                            int ny = p.y + dy;
-                            if (nx >= 0 && ny >= 0 && nx < pixelWidth && ny < pixelHeight) {
-                                if (getPixelMask(nx, ny, mask, pixelWidth)) {
-                                    clearPixelMask(nx, ny, mask, pixelWidth);
-                                    queue.push_back({nx, ny});
-                                }
-                            }
-                        }
-                    }
-                }
-
-                // Compute centroid
-                blob.centreX = (float)blob.sumX / blob.pixelCount;
-                blob.centreY = (float)blob.sumY / blob.pixelCount;
-                // Only push large blobs
-                if (blob.pixelCount > 4) {
-                    blobs.push_back(blob);
-                }
-            }
-        }
-    }
-    tempID = 0;
+void rescaleTracker(TrackerState &state, FrameSize from, FrameSize to) {
+    if (state.lastCentroidX == -1 || state.lastCentroidY == -1) return;
+    state.lastCentroidX = state.lastCentroidX * to.width / from.width;
+    state.lastCentroidY = state.lastCentroidY * to.height / from.height;
 }
-
-
-
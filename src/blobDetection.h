@@ -1,9 +1,12 @@
+#pragma once
 #include <stdint.h>
 #include <vector>
+#include "geometry.h"
 
 
 
 extern int blobThreshold; // Maximum deviation for blob tracking (pixels)
+extern int blobMinPixels;
 
 struct Blob {
     int id;
@@ -21,6 +24,13 @@ struct TrackerState {
     int lastCentroidX = -1;
     int lastCentroidY = -1;
     int lastPixelCount = 0;
+
+    // Motion estimate used to extrapolate the target past the pipeline latency.
+    // Units are whatever updateTargetMotion() is fed (world degrees in the firmware).
+    bool motionValid = false;
+    float posX = 0, posY = 0;
+    float velX = 0, velY = 0;   // Units per second
+    uint32_t lastTimestamp = 0; // micros() when the frame was exposed
 };
 
 inline bool getPixelMask(int x, int y, const uint8_t* mask, int pixelWidth) {
@@ -33,10 +43,109 @@ inline void clearPixelMask(int x, int y, uint8_t* mask, int pixelWidth) {
     mask[idx >> 3] &= ~(1 << (idx & 7));
 }
 
-void detectBlobs(int pixelHeight, int pixelWidth, uint8_t mask[], std::vector<Blob> &blobs);
+// Flood fill stack, shared by every geometry. Holds any 160x120 blob, at higher
+// resolutions a blob that overflows it is split where the stack filled.
+constexpr uint32_t labelStackSize = ReferenceGeometry::pixels;
+extern uint32_t labelStack[labelStackSize];
+extern int tempID;
+
+// blobMinPixels is in ReferenceGeometry pixels, scaled by area to Geometry's
+template <typename Geometry>
+int scaledMinPixels() {
+    return (int)((int64_t)blobMinPixels * Geometry::pixels / ReferenceGeometry::pixels);
+}
+
+// Labels 8-connected blobs in the mask, clearing it. Scale is the frame the
+// mask's pixels are from: a sensor window's mask is smaller than the frame,
+// its pixels aren't, so the size threshold stays the frame's.
+template <typename Geometry, typename Scale = Geometry>
+void detectBlobs(uint8_t mask[], std::vector<Blob> &blobs) {
+    constexpr int width = Geometry::width;
+    constexpr int height = Geometry::height;
+    const int minPixels = scaledMinPixels<Scale>();
+    blobs.clear();
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (getPixelMask(x, y, mask, width)) {
+                // Start Blob
+                tempID += 1;
+                Blob blob;
+                blob.id = tempID;
+                blob.minX = blob.maxX = x;
+                blob.minY = blob.maxY = y;
+                blob.sumX = blob.sumY = 0;
+                blob.pixelCount = 0;
 
-void setCurrentTarget(std::vector<Blob> &blobs, bool &targetSet, TrackerState &state);
+                uint32_t depth = 0;
+                labelStack[depth++] = y * width + x;
+                clearPixelMask(x, y, mask, width);
+
+                while (depth > 0) {
+                    uint32_t idx = labelStack[--depth];
+                    int px = idx % width;
+                    int py = idx / width;
+
+                    // Update blob statistics
+                    blob.sumX += px;
+                    blob.sumY += py;
+                    blob.pixelCount++;
+                    if (px < blob.minX) blob.minX = px;
+                    if (px > blob.maxX) blob.maxX = px;
+                    if (py < blob.minY) blob.minY = py;
+                    if (py > blob.maxY) blob.maxY = py;
+
+                    // Check 8-connected neighbors, left set if the stack is full
+                    for (int dy = -1; dy <= 1; dy++) {
+                        for (int dx = -1; dx <= 1; dx++) {
+                            if (dx == 0 && dy == 0) continue;
+                            int nx = px + dx;
+                            int ny = py + dy;
+                            if (nx >= 0 && ny >= 0 && nx < width && ny < height && depth < labelStackSize) {
+                                if (getPixelMask(nx, ny, mask, width)) {
+                                    clearPixelMask(nx, ny, mask, width);
+                                    labelStack[depth++] = ny * width + nx;
+                                }
+                            }
+                        }
+                    }
+                }
+
+                // Compute centroid
+                blob.centreX = (float)blob.sumX / blob.pixelCount;
+                blob.centreY = (float)blob.sumY / blob.pixelCount;
+                // Only push large blobs
+                if (blob.pixelCount > minPixels) {
+                    blobs.push_back(blob);
+                }
+            }
+        }
+    }
+    tempID = 0;
+}
+
+// First blob over minPixels becomes the target
+void setCurrentTarget(std::vector<Blob> &blobs, int minPixels, bool &targetSet, TrackerState &state);
+
+// Same size threshold as the labeller, blobMinPixels scaled to Geometry
+template <typename Geometry>
+void setCurrentTarget(std::vector<Blob> &blobs, bool &targetSet, TrackerState &state) {
+    setCurrentTarget(blobs, scaledMinPixels<Geometry>(), targetSet, state);
+}
 
 
 
 Pixel trackBlob(const std::vector<Blob> &blobs, int blobThreshold, TrackerState &state);
+
+// blobThreshold is in ReferenceGeometry pixels
+template <typename Geometry>
+Pixel trackBlob(const std::vector<Blob> &blobs, int blobThreshold, TrackerState &state) {
+    return trackBlob(blobs, blobThreshold * Geometry::width / ReferenceGeometry::width, state);
+}
+
+// Keep the last centroid meaningful across an output size change
+void rescaleTracker(TrackerState &state, FrameSize from, FrameSize to);
+
+void updateTargetMotion(TrackerState &state, float x, float y, uint32_t timestamp);
+void resetTargetMotion(TrackerState &state);
+void predictTarget(const TrackerState &state, uint32_t atTime, float &x, float &y);
@@ -0,0 +1,119 @@
+#include "calibration.h"
+#include <cmath>
+
+const float stepDegrees = 6.0f;
+const float minShiftPixels = 3.0f; // Smaller shifts mean the target wasn't seen moving
+const int settleFrames = 8;        // Frames discarded while the servo settles
+const int averageFrames = 3;       // Frames averaged for the before/after positions
+const int responseFrames = 20;     // Frames sampled after each step
+
+struct StepSample {
+  float pos;
+  uint32_t time;
+};
+
+static bool measureAxisPosition(const CalibrationIO &io, int axis, float &pos, uint32_t &time) {
+  float x, y;
+  if (!io.measure(x, y, time)) return false;
+  pos = axis == 0 ? x : y;
+  return true;
+}
+
+static bool averagePosition(const CalibrationIO &io, int axis, float &pos) {
+  float sum = 0;
+  uint32_t time;
+  for (int i = 0; i < averageFrames; i++) {
+    float p;
+    if (!measureAxisPosition(io, axis, p, time)) return false;
+    sum += p;
+  }
+  pos = sum / averageFrames;
+  return true;
+}
+
+// Step one servo and watch the target shift in the image. Returns the shift in
+// pixels per degree (signed) and the time to reach 63% of it.
+static bool measureAxis(const CalibrationIO &io, int axis, float start, float &shiftPerDegree, float &lag) {
+  io.moveServo(axis, start);
+  for (int i = 0; i < settleFrames; i++) {
+    float p;
+    uint32_t t;
+    measureAxisPosition(io, axis, p, t);
+  }
+
+  float before;
+  bool ok = averagePosition(io, axis, before);
+
+  StepSample samples[responseFrames];
+  int count = 0;
+  uint32_t stepTime = io.now();
+  io.moveServo(axis, start + stepDegrees);
+  for (int i = 0; ok && i < responseFrames; i++) {
+    if (measureAxisPosition(io, axis, samples[count].pos, samples[count].time)) count++;
+  }
+  io.moveServo(axis, start);
+  if (!ok || count < averageFrames + 2) return false;
+
+  float after = 0;
+  for (int i = count - averageFrames; i < count; i++) after += samples[i].pos;
+  after /= averageFrames;
+
+  float shift = after - before;
+  if (std::fabs(shift) < minShiftPixels) return false;
+  shiftPerDegree = shift / stepDegrees;
+
+  // Interpolate the 63.2% crossing between the frames either side of it
+  float threshold = before + shift * 0.632f;
+  float prevPos = before;
+  uint32_t prevTime = stepTime;
+  for (int i = 0; i < count; i++) {
+    if ((samples[i].pos - threshold) * shift >= 0) {
+      float span = samples[i].pos - prevPos;
+      float frac = span != 0 ? (threshold - prevPos) / span : 1.0f;
+      float crossing = prevTime + frac * (samples[i].time - prevTime);
+      lag = (crossing - stepTime) * 1e-6f;
+      return lag > 0;
+    }
+    prevPos = samples[i].pos;
+    prevTime = samples[i].time;
+  }
+  return false;
+}
+
+bool runCalibration(const CalibrationIO &io, float startPan, float startTilt, Calibration &result) {
+  float shiftX, shiftY, lagH, lagV;
+
+  io.moveServo(1, startTilt);
+  if (!measureAxis(io, 0, startPan, shiftX, lagH)) return false;
+  if (!measureAxis(io, 1, startTilt, shiftY, lagV)) return false;
+
+  // The scene moves left when the camera turns right, and down when it turns up
+  result.pixelsPerDegreeX = std::fabs(shiftX);
+  result.pixelsPerDegreeY = std::fabs(shiftY);
+  result.panSign = shiftX < 0 ? 1.0f : -1.0f;
+  result.tiltSign = shiftY > 0 ? 1.0f : -1.0f;
+  result.lagH = lagH;
+  result.lagV = lagV;
+  result.valid = true;
+  return true;
+}
+
+// Command loop about twice as slow as the servo, so it never runs ahead of the mechanics
+static void scheduleGains(AxisController &axis, float lag) {
+  axis.lag = lag;
+  axis.kp = std::fmax(2.0f, std::fmin(0.5f / lag, 20.0f));
+  axis.ki = 0.05f * axis.kp;
+}
+
+void applyCalibration(const Calibration &cal, CameraModel &model, AxisController &pan, AxisController &tilt) {
+  if (!cal.valid) return;
+
+  // Near the centre one degree moves the image by f * (pi / 180) pixels
+  model.fx = cal.pixelsPerDegreeX * 180.0f / 3.14159265f;
+  model.fy = cal.pixelsPerDegreeY * 180.0f / 3.14159265f;
+  model.panSign = cal.panSign;
+  model.tiltSign = cal.tiltSign;
+
+  scheduleGains(pan, cal.lagH);
+  scheduleGains(tilt, cal.lagV);
+}
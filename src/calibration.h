@@ -0,0 +1,25 @@
+#pragma once
+#include <stdint.h>
+#include "kinematics.h"
+#include "servoControl.h"
+
+// Per-rig servo/camera relationship measured by runCalibration()
+struct Calibration {
+  bool valid = false;
+  float pixelsPerDegreeX = 0, pixelsPerDegreeY = 0; // Near the image centre
+  float panSign = 1, tiltSign = 1;                  // Same meaning as CameraModel
+  float lagH = 0, lagV = 0;                         // First-order servo time constant (seconds)
+};
+
+// Hooks into the firmware so the routine itself stays hardware independent
+struct CalibrationIO {
+  bool (*measure)(float &x, float &y, uint32_t &timestamp); // Capture a frame, centroid of the target
+  void (*moveServo)(int axis, float degrees);                // 0 = pan, 1 = tilt
+  uint32_t (*now)();                                         // Same clock as the measure timestamps
+};
+
+// Steps each servo by a known amount while watching a static target
+bool runCalibration(const CalibrationIO &io, float startPan, float startTilt, Calibration &result);
+
+// Update the camera model and schedule controller gains from the measured lag
+void applyCalibration(const Calibration &cal, CameraModel &model, AxisController &pan, AxisController &tilt);
@@ -1,56 +1,181 @@
 #include <camera.h>
 #include <Arduino.h>
 #include <blobDetection.h>
+#include <telemetry.h>
+#include <algorithm>
 
-// Buffer
-// (Buffer is chunkSize (64) bytes long)
-const int chunkSize = 64; 
-uint8_t sendBuffer[chunkSize];
-int bufIndex = 0;
-
-// For live view using getMask.py
-void printMask() {
-  for (int y = 0; y < pixelHeight; y++) {
-    for (int x = 0; x < pixelWidth; x++) {
-      Serial.print(getPixelMask(x, y, mask, pixelWidth) ? "1" : "0");
+StreamMode streamMode = STREAM_OFF;
+uint8_t blobsOut = 0; // Runtime, param.py and the host harnesses turn it on
+bool frameQueued = false; // Current frame is being copied to the telemetry buffer
+uint16_t frameWidth = ReferenceGeometry::width;
+uint16_t frameHeight = ReferenceGeometry::height;
+uint16_t rowBuffer[MaxGeometry::width];
+uint8_t previewShift = 0;
+StreamWindow streamWindow;
+DMAMEM uint8_t lumaPlane[MaxGeometry::pixels];
+uint32_t streamedBytes = 0;
+
+// Compressed streaming, the encoder's copy of what the host last decoded
+DMAMEM uint16_t previousFrame[MaxGeometry::pixels];
+int framesSinceKey = keyframeInterval;
+
+uint32_t sensorFramePeriod = 0;
+
+uint32_t framePeriodMark = 0;
+
+void updateFramePeriod(const FrameTiming &t) {
+  if (framePeriodMark == 0) return;
+  sensorFramePeriod = (t.captureDone - framePeriodMark) / 2;
+  framePeriodMark = 0;
+}
+
+// For live view using getMask.py. Must run before detectBlobs(), which clears the mask.
+// Run-length coded when that is smaller (almost always), else the packed bits.
+void sendMask() {
+  if (!maskOut) return;
+
+  static uint8_t payload[4 + bitmaskSize];
+  const int maskBytes = (frameWidth * frameHeight + 7) / 8;
+  put16(payload, frameWidth);
+  put16(payload + 2, frameHeight);
+  size_t length = encodeMaskRle(mask, frameWidth * frameHeight, payload + 4, maskBytes);
+  uint8_t flags = MASK_RLE;
+  if (length == 0) {
+    memcpy(payload + 4, mask, maskBytes);
+    length = maskBytes;
+    flags = 0;
+  }
+  telemetrySend(MSG_MASK, flags, frameTimestamp(frameTiming), payload, 4 + length);
+}
+
+// Window of roiSize centred on the target (frame centre without one), shifted to stay inside the frame
+static void placeWindow(int targetX, int targetY) {
+  if (targetX < 0 || targetY < 0) {
+    targetX = frameWidth / 2;
+    targetY = frameHeight / 2;
+  }
+  streamWindow.minX = std::clamp(targetX - roiSize / 2, 0, frameWidth - roiSize);
+  streamWindow.minY = std::clamp(targetY - roiSize / 2, 0, frameHeight - roiSize);
+  streamWindow.maxX = streamWindow.minX + roiSize;
+  streamWindow.maxY = streamWindow.minY + roiSize;
+}
+
+// Worst case frame message in the current stream mode, 'shift' decimating it
+static uint32_t previewMessageSize(uint8_t shift) {
+  uint32_t width = (frameWidth + (1 << shift) - 1) >> shift;
+  uint32_t height = (frameHeight + (1 << shift) - 1) >> shift;
+  uint32_t payload = streamMode == STREAM_RAW ? width * height * 2 : height * deltaRowMaxSize(width);
+  return headerSize + 4 + payload + trailerSize;
+}
+
+// Frame message header. The frame is only queued if the whole thing fits in
+// the telemetry buffer, otherwise it is dropped (host too slow). A dropped
+// compressed frame doesn't update previousFrame, so the delta chain stays valid.
+// targetX/Y is the last tracked position (-1 for none), used by STREAM_ROI.
+void initializeFrame(int targetX, int targetY) {
+  frameQueued = false;
+  if (streamMode == STREAM_OFF || (frameTiming.frame % telemetryDecimation) != 0) return;
+
+  if (streamMode == STREAM_ROI) {
+    // Window and origin are known before readout, so the header goes out first like a raw frame
+    placeWindow(targetX, targetY);
+    uint8_t flags = targetX >= 0 ? ROI_ON_TARGET : 0;
+    frameQueued = telemetryBeginMessage(MSG_ROI_FRAME, flags, frameTimestamp(frameTiming), 12 + roiSize * roiSize * 2);
+    if (frameQueued) {
+      uint8_t window[12];
+      put16(window, frameWidth);
+      put16(window + 2, frameHeight);
+      put16(window + 4, streamWindow.minX);
+      put16(window + 6, streamWindow.minY);
+      put16(window + 8, roiSize);
+      put16(window + 10, roiSize);
+      telemetryWrite(window, sizeof(window));
+    }
+    return;
+  }
+
+  // Smallest decimation that fits the budget, the host is sent the reduced size
+  uint8_t shift = 0;
+  while (previewMessageSize(shift) > telemetryFrameBudget) shift++;
+  if (shift != previewShift) {
+    previewShift = shift;
+    restartStream(); // Different size, the delta chain can't carry over
+  }
+  const int width = (frameWidth + (1 << shift) - 1) >> shift;
+  const int height = (frameHeight + (1 << shift) - 1) >> shift;
+
+  if (streamMode == STREAM_RAW) {
+    frameQueued = telemetryBeginMessage(MSG_RAW_FRAME, 0, frameTimestamp(frameTiming), 4 + width * height * 2);
+  } else {
+    bool keyframe = framesSinceKey >= keyframeInterval;
+    uint32_t maxLength = 4 + height * deltaRowMaxSize(width);
+    frameQueued = telemetryBeginMessage(MSG_DELTA_FRAME, keyframe ? DELTA_KEYFRAME : 0,
+                                        frameTimestamp(frameTiming), maxLength);
+    if (frameQueued) {
+      if (keyframe) {
+        memset(previousFrame, 0, sizeof(previousFrame));
+        framesSinceKey = 0;
+      }
+      framesSinceKey++;
     }
-    Serial.println();
+  }
+
+  if (frameQueued) {
+    uint8_t size[4];
+    put16(size, width);
+    put16(size + 2, height);
+    telemetryWrite(size, sizeof(size));
   }
 }
 
-// Beginning of frame byte marker
-void initializeFrame() {
-  if (serialOut) {
-      while (Serial.availableForWrite() < 2) yield();
-      Serial.write(startByte, sizeof(startByte));
+// Stream mode changed, start the host off with a keyframe
+void restartStream() {
+  framesSinceKey = keyframeInterval;
+}
+
+// Next frame is a different size, the delta chain can't carry over
+void setFrameGeometry(uint16_t width, uint16_t height) {
+  frameWidth = width;
+  frameHeight = height;
+  restartStream();
+}
+
+// Compress a finished row straight into the telemetry buffer
+void endRow(int y) {
+  if (frameQueued && streamMode == STREAM_COMPRESSED && (y & ((1 << previewShift) - 1)) == 0) {
+    uint8_t encoded[deltaRowMaxSize(MaxGeometry::width)];
+    const int width = (frameWidth + (1 << previewShift) - 1) >> previewShift;
+    size_t length = encodeDeltaRow(rowBuffer, previousFrame + (y >> previewShift) * width, width, deltaTolerance, encoded);
+    telemetryWrite(encoded, length);
   }
 }
 
-// End of frame byte marker
+// Payload CRC, message becomes sendable
 void endFrame() {
-  if (serialOut) {
-    while (Serial.availableForWrite() < 2) yield();
-    Serial.write(endByte, sizeof(endByte));
-    Serial.flush();  // Waits until all data is sent
+  if (frameQueued) {
+    streamedBytes = telemetryEndMessage();
+    frameQueued = false;
   }
 }
 
-void readBytes(uint8_t low, uint8_t high) {
-  if (serialOut) {
-    sendBuffer[bufIndex++] = low;
-    sendBuffer[bufIndex++] = high;
-
-    if (bufIndex >= chunkSize) {
-      while (Serial.availableForWrite() < bufIndex) yield();
-      Serial.write(sendBuffer, bufIndex);
-      bufIndex = 0;
-    }
+void sendFrameRecord(const FrameRecord &record) {
+  if (blobsOut) {
+    uint8_t payload[frameRecordMaxSize];
+    size_t length = encodeFrameRecord(payload, record);
+    telemetrySend(MSG_BLOBS, 0, record.captureStart, payload, length);
   }
 }
 
-void flushBuffer() {
-  if (bufIndex > 0 && serialOut) {
-    while (Serial.availableForWrite() < bufIndex) yield();
-    Serial.write(sendBuffer, bufIndex);
+// Pipeline latency for tuning the tracker lead
+void sendStats(const FrameTiming &t) {
+  if (statsOut) {
+    uint8_t payload[24];
+    put32(payload, t.captureStart);
+    put32(payload + 4, t.captureDone);
+    put32(payload + 8, t.processDone);
+    put32(payload + 12, telemetryDropped());
+    put32(payload + 16, streamedBytes); // Last streamed frame, compression ratio on the host
+    put32(payload + 20, 1 << previewShift); // Preview decimation, 1 = full size
+    telemetrySend(MSG_STATS, 0, frameTimestamp(t), payload, sizeof(payload));
   }
-}
\ No newline at end of file
+}
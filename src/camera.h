@@ -1,22 +1,116 @@
+#pragma once
 #include <stdint.h>
+#include <telemetry.h>
+#include <geometry.h>
 
-constexpr bool serialOut = false;
+// Live frame streaming for getSerial.py
+enum StreamMode : uint8_t {
+  STREAM_OFF,
+  STREAM_RAW,        // MSG_RAW_FRAME, up to 38 KB per frame (decimated past 160x120)
+  STREAM_COMPRESSED, // MSG_DELTA_FRAME, row delta against the last sent frame + RLE
+  STREAM_ROI,        // MSG_ROI_FRAME, roiSize window around the target, ~2 KB per frame
+};
+extern StreamMode streamMode;
+constexpr int keyframeInterval = 30; // Compressed frames between keyframes (recovers from lost data)
+constexpr int deltaTolerance = 1;    // Per-channel change treated as noise when compressing (0 = lossless)
+constexpr int roiSize = 32;          // Square window streamed in STREAM_ROI
 
-// Camera resolution
-constexpr uint16_t pixelWidth = 160;
-constexpr uint16_t pixelHeight = 120;
+// Sensor output read by the pipeline
+enum CaptureFormat : uint8_t {
+  CAPTURE_RGB565, // Classified with the RGB565 table (classifier.h)
+  CAPTURE_YUV422, // Y U Y V pairs, classified on chroma, fills lumaPlane
+};
 
-// Image mask
-constexpr int bitmaskSize = (pixelWidth * pixelHeight + 7) / 8;
+constexpr bool maskOut = false;  // Send a MSG_MASK per frame (for getMask.py)
+constexpr bool statsOut = false; // Send a MSG_STATS timing record per tracked frame
+extern uint8_t blobsOut;         // Send a MSG_BLOBS record per frame (~300 bytes), off by default
+
+// Active camera resolution, changed between frames by setFrameGeometry()
+extern uint16_t frameWidth;
+extern uint16_t frameHeight;
+
+// Image mask, sized for the largest geometry
+constexpr int bitmaskSize = MaxGeometry::maskBytes;
 extern uint8_t mask[bitmaskSize]; // 1D bit array 
 
-// If frames need to be sent via serial
-const uint8_t startByte[] = { 0xAA, 0x55, 0xAA, 0x55 };
-const uint8_t endByte[]   = { 0x55, 0xAA, 0x55, 0xAA };
+// Y of the last YUV422 frame, frameWidth x frameHeight
+extern uint8_t lumaPlane[MaxGeometry::pixels];
+
+// Per-frame timestamps in micros()
+struct FrameTiming {
+  uint32_t frame;        // Sequential capture counter
+  uint32_t captureStart; // start_capture() issued
+  uint32_t captureDone;  // CAP_DONE seen, FIFO readout begins
+  uint32_t readoutDone;  // FIFO read and mask classified
+  uint32_t detectDone;   // Blobs labelled
+  uint32_t processDone;  // Target resolved and published
+  bool captured;         // False when CAP_DONE timed out, the frame has no data
+};
+extern FrameTiming frameTiming;
+
+// Sensor frame period in micros, 0 until measured. CAP_DONE comes at a VSYNC,
+// and a capture triggered just after it waits out that frame before taking the
+// next one, so its CAP_DONE is two periods after the mark (markFramePeriod() in
+// main.cpp). Trigger to CAP_DONE alone only bounds it, whatever the loop's phase.
+extern uint32_t sensorFramePeriod;
+extern uint32_t framePeriodMark; // CAP_DONE of the throwaway capture, 0 = not measuring
+void updateFramePeriod(const FrameTiming &t);
 
+// The frame is exposed somewhere between trigger and CAP_DONE, take the middle
+inline uint32_t frameTimestamp(const FrameTiming &t) {
+  return t.captureStart + (t.captureDone - t.captureStart) / 2;
+}
 
-void printMask();
-void initializeFrame();
+extern bool frameQueued;
+extern uint16_t rowBuffer[MaxGeometry::width];
+// RAW and COMPRESSED previews stream every (1 << previewShift)th pixel and row,
+// so the frame message fits telemetryFrameBudget
+extern uint8_t previewShift;
+
+// Region streamed in STREAM_ROI, fixed for the frame by initializeFrame()
+struct StreamWindow {
+  int minX, maxX; // Exclusive max
+  int minY, maxY;
+};
+extern StreamWindow streamWindow;
+
+void sendMask();
+void initializeFrame(int targetX, int targetY);
 void endFrame();
-void readBytes(uint8_t low, uint8_t high);
-void flushBuffer();
\ No newline at end of file
+void endRow(int y);
+void restartStream();
+void setFrameGeometry(uint16_t width, uint16_t height);
+void sendStats(const FrameTiming &t);
+void sendFrameRecord(const FrameRecord &record);
+
+// Called per pixel, keep it inline
+inline void streamPixel(int x, int y, uint8_t low, uint8_t high) {
+  if (!frameQueued) return;
+  if (streamMode == STREAM_ROI) {
+    if (x >= streamWindow.minX && x < streamWindow.maxX && y >= streamWindow.minY && y < streamWindow.maxY) {
+      telemetryWriteByte(low);
+      telemetryWriteByte(high);
+    }
+    return;
+  }
+  if ((x | y) & ((1 << previewShift) - 1)) return;
+  if (streamMode == STREAM_RAW) {
+    telemetryWriteByte(low);
+    telemetryWriteByte(high);
+  } else {
+    rowBuffer[x >> previewShift] = (high << 8) | low; // Encoded by endRow()
+  }
+}
+
+// Streams are RGB565, only converted when a YUV422 frame is being sent.
+// BT.601 full range, integer.
+inline uint16_t yuvToRgb565(uint8_t y, uint8_t u, uint8_t v) {
+  int d = u - 128, e = v - 128;
+  int r = y + ((359 * e) >> 8);
+  int g = y - ((88 * d + 183 * e) >> 8);
+  int b = y + ((454 * d) >> 8);
+  r = r < 0 ? 0 : (r > 255 ? 255 : r);
+  g = g < 0 ? 0 : (g > 255 ? 255 : g);
+  b = b < 0 ? 0 : (b > 255 ? 255 : b);
+  return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+}
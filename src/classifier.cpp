@@ -0,0 +1,31 @@
+#include "classifier.h"
+#include <stdlib.h>
+#include <string.h>
+
+ColourThresholds colourThresholds;
+ChromaThresholds chromaThresholds;
+uint8_t classifierTable[classifierTableSize];
+
+bool classifyColour(const ColourThresholds &t, uint16_t rgb565) {
+  uint8_t r = (rgb565 >> 11) & 0x1F;
+  uint8_t g = (rgb565 >> 5) & 0x3F;
+  uint8_t b = rgb565 & 0x1F;
+
+  r = (r * 255) / 31;
+  g = (g * 255) / 63;
+  b = (b * 255) / 31;
+
+  return (r > t.rMin && r < t.rMax) &&
+         (g > t.gMin && g < t.gMax) &&
+         (b > t.bMin && b < t.bMax) &&
+         (abs(g - b) < t.maxGreenBlue);
+}
+
+// ~65k evaluations. Only runs at boot and on a threshold change, between
+// frames; setup() prints how long the boot rebuild took.
+void buildClassifier(const ColourThresholds &t) {
+  memset(classifierTable, 0, sizeof(classifierTable));
+  for (uint32_t value = 0; value < 65536; value++) {
+    if (classifyColour(t, value)) classifierTable[value >> 3] |= 1 << (value & 7);
+  }
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <stdint.h>
+
+// Target colour window on RGB888 expanded from RGB565, bounds are exclusive
+struct ColourThresholds {
+  int rMin = 110, rMax = 255;
+  int gMin = 0, gMax = 60;
+  int bMin = 0, bMax = 90;
+  int maxGreenBlue = 30; // |g - b| below this
+};
+
+extern ColourThresholds colourThresholds;
+
+// One bit per RGB565 value, rebuilt whenever the thresholds change
+constexpr uint32_t classifierTableSize = 65536 / 8;
+extern uint8_t classifierTable[classifierTableSize];
+
+bool classifyColour(const ColourThresholds &t, uint16_t rgb565);
+void buildClassifier(const ColourThresholds &t);
+
+// Per pixel in the readout loop, keep it inline
+inline bool isTargetColour(uint16_t rgb565) {
+  return (classifierTable[rgb565 >> 3] >> (rgb565 & 7)) & 1;
+}
+
+// YUV422 capture: a window on the chroma, Y only gates out pixels too dark or
+// too bright to carry usable colour. Bounds are exclusive. Compared directly,
+// no table to rebuild.
+struct ChromaThresholds {
+  int yMin = 30, yMax = 240;
+  int uMin = 0, uMax = 135;   // Cb
+  int vMin = 150, vMax = 256; // Cr
+};
+
+extern ChromaThresholds chromaThresholds;
+
+// Once per pixel pair, U and V are shared
+inline bool isTargetChroma(uint8_t u, uint8_t v) {
+  const ChromaThresholds &t = chromaThresholds;
+  return u > t.uMin && u < t.uMax && v > t.vMin && v < t.vMax;
+}
+
+inline bool isTargetLuma(uint8_t y) {
+  return y > chromaThresholds.yMin && y < chromaThresholds.yMax;
+}
@@ -0,0 +1,75 @@
+#include <commands.h>
+#include <Arduino.h>
+#include <string.h>
+#include <params.h>
+#include <telemetry.h>
+#include <configStore.h>
+
+StreamParser commandParser;
+uint8_t commandPayload[commandMaxPayload];
+
+void initCommands() {
+  initParser(commandParser, commandPayload, sizeof(commandPayload));
+}
+
+static void sendParameter(uint8_t id, const Parameter *p, uint8_t status) {
+  uint8_t reply[paramReplyFixedSize + 32];
+  size_t nameLength = p ? strnlen(p->name, 32) : 0;
+  memset(reply, 0, paramReplyFixedSize);
+  reply[0] = id;
+  reply[2] = status;
+  if (p) {
+    reply[1] = p->type;
+    putFloat(reply + 3, getParameter(*p));
+    putFloat(reply + 7, p->min);
+    putFloat(reply + 11, p->max);
+    memcpy(reply + paramReplyFixedSize, p->name, nameLength);
+  }
+  telemetrySend(MSG_PARAM, 0, micros(), reply, paramReplyFixedSize + nameLength);
+}
+
+static void handleCommand(const MessageHeader &header, const uint8_t *payload) {
+  if (header.type == MSG_GET_PARAM && header.length == 1) {
+    if (payload[0] == PARAM_ALL) {
+      for (int i = 0; i < parameterCount; i++) sendParameter(parameters[i].id, &parameters[i], PARAM_OK);
+    } else {
+      const Parameter *p = findParameter(parameters, parameterCount, payload[0]);
+      sendParameter(payload[0], p, p ? PARAM_OK : PARAM_UNKNOWN);
+    }
+  } else if (header.type == MSG_SET_PARAM && header.length == 5) {
+    const Parameter *p = findParameter(parameters, parameterCount, payload[0]);
+    uint8_t status = PARAM_UNKNOWN;
+    if (p) status = setParameter(*p, getFloat(payload + 1)) ? PARAM_OK : PARAM_RANGE;
+    sendParameter(payload[0], p, status);
+  } else if (header.type == MSG_CONFIG_COMMAND && header.length == 1) {
+    uint8_t reply[4] = { payload[0], 1, 0, 0 };
+    if (payload[0] == CONFIG_SAVE) {
+      uint32_t stored = saveConfig();
+      reply[1] = stored ? 0 : 1;
+      put16(reply + 2, stored);
+    } else if (payload[0] == CONFIG_ERASE) {
+      eraseConfig();
+      reply[1] = 0;
+    }
+    telemetrySend(MSG_CONFIG_RESULT, 0, micros(), reply, sizeof(reply));
+  } else if (header.type == MSG_GET_SENSOR_STATE) {
+    sendSensorState();
+  } else if (header.type == MSG_GET_PARAM || header.type == MSG_SET_PARAM) {
+    sendParameter(header.length ? payload[0] : 0, nullptr, PARAM_MALFORMED);
+  }
+}
+
+// At most commandBudget bytes per call, so a burst from the host can't stretch
+// the frame loop. Anything left waits in the USB buffer for the next pass.
+void serviceCommands() {
+  uint8_t data[commandBudget];
+  size_t length = 0;
+  while (length < sizeof(data) && Serial.available() > 0) data[length++] = Serial.read();
+
+  size_t offset = 0;
+  while (offset < length) {
+    bool complete;
+    offset += parseStream(commandParser, data + offset, length - offset, complete);
+    if (complete) handleCommand(commandParser.current, commandPayload);
+  }
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <stdint.h>
+
+// Host -> device commands arrive framed like telemetry (src/protocol.h) and
+// are polled from loop(). Replies go out through the telemetry buffer.
+constexpr int commandBudget = 64;      // Serial bytes parsed per serviceCommands() call
+constexpr int commandMaxPayload = 32;  // Larger commands are discarded by the parser
+
+void initCommands();
+void serviceCommands();
+
+// main.cpp, answers MSG_GET_SENSOR_STATE from the driver's register shadow
+void sendSensorState();
@@ -0,0 +1,88 @@
+#include "config.h"
+#include <string.h>
+#include "protocol.h"
+
+size_t encodeConfig(const Parameter *table, int count, const Calibration &cal, const uint8_t *classifier,
+                    uint8_t *out, size_t capacity) {
+  if (count > maxConfigParams) count = maxConfigParams;
+  size_t fixed = configHeaderSize + 1 + count * 5 + configCalibrationSize + 2;
+  if (fixed > capacity) return 0;
+
+  uint8_t *p = out + configHeaderSize;
+  *p++ = count;
+  for (int i = 0; i < count; i++) {
+    *p++ = table[i].id;
+    putFloat(p, getParameter(table[i]));
+    p += 4;
+  }
+
+  *p++ = cal.valid;
+  putFloat(p, cal.pixelsPerDegreeX);
+  putFloat(p + 4, cal.pixelsPerDegreeY);
+  putFloat(p + 8, cal.panSign);
+  putFloat(p + 12, cal.tiltSign);
+  putFloat(p + 16, cal.lagH);
+  putFloat(p + 20, cal.lagV);
+  p += 24;
+
+  // Table is mostly long runs, typically a few hundred bytes coded
+  size_t tableLength = classifier ? encodeMaskRle(classifier, 65536, p + 2, capacity - fixed) : 0;
+  if (tableLength > 0xFFFF) tableLength = 0;
+  put16(p, tableLength);
+  p += 2 + tableLength;
+
+  size_t payloadLength = p - (out + configHeaderSize);
+  put32(out, configMagic);
+  put16(out + 4, configVersion);
+  put16(out + 6, payloadLength);
+  put32(out + 8, crc32(out + configHeaderSize, payloadLength));
+  return configHeaderSize + payloadLength;
+}
+
+bool decodeConfig(const uint8_t *in, size_t length, ConfigData &config) {
+  if (length < configHeaderSize || get32(in) != configMagic || get16(in + 4) != configVersion) return false;
+  size_t payloadLength = get16(in + 6);
+  if (configHeaderSize + payloadLength > length) return false;
+  const uint8_t *p = in + configHeaderSize;
+  const uint8_t *end = p + payloadLength;
+  if (get32(in + 8) != crc32(p, payloadLength)) return false;
+
+  if (end - p < 1) return false;
+  config.paramCount = *p++;
+  if (config.paramCount > maxConfigParams || end - p < config.paramCount * 5 + (int)configCalibrationSize + 2) return false;
+  for (int i = 0; i < config.paramCount; i++) {
+    config.paramIds[i] = *p++;
+    config.paramValues[i] = getFloat(p);
+    p += 4;
+  }
+
+  Calibration &cal = config.calibration;
+  cal.valid = *p++ != 0;
+  cal.pixelsPerDegreeX = getFloat(p);
+  cal.pixelsPerDegreeY = getFloat(p + 4);
+  cal.panSign = getFloat(p + 8);
+  cal.tiltSign = getFloat(p + 12);
+  cal.lagH = getFloat(p + 16);
+  cal.lagV = getFloat(p + 20);
+  p += 24;
+
+  config.classifierRleLength = get16(p);
+  p += 2;
+  if ((size_t)(end - p) != config.classifierRleLength) return false;
+  config.classifierRle = config.classifierRleLength ? p : nullptr;
+  return true;
+}
+
+int applyConfigParameters(const ConfigData &config, const Parameter *table, int count) {
+  int applied = 0;
+  for (int i = 0; i < config.paramCount; i++) {
+    const Parameter *p = findParameter(table, count, config.paramIds[i]);
+    if (p && setParameter(*p, config.paramValues[i], false)) applied++;
+  }
+  return applied;
+}
+
+bool loadConfigClassifier(const ConfigData &config, uint8_t *classifier) {
+  if (!config.classifierRle) return false;
+  return decodeMaskRle(config.classifierRle, config.classifierRleLength, classifier, 65536);
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "params.h"
+#include "calibration.h"
+
+// Saved configuration: parameter values, calibration and optionally the
+// classifier table. Layout (little-endian):
+//   uint32 magic, uint16 version, uint16 payload length, uint32 CRC32 of payload
+//   payload: uint8 count, count x (uint8 id, float value)
+//            calibration (uint8 valid, 6 floats)
+//            uint16 table length, classifier table as mask RLE (0 = not stored)
+// Parameters are stored by id, so values for ids a newer firmware dropped are
+// skipped and new ids keep their defaults.
+constexpr uint32_t configMagic = 0x564D4245; // "EBMV"
+constexpr uint16_t configVersion = 1;
+constexpr size_t configHeaderSize = 12;
+constexpr size_t configCalibrationSize = 25;
+constexpr int maxConfigParams = 64;
+
+struct ConfigData {
+  int paramCount;
+  uint8_t paramIds[maxConfigParams];
+  float paramValues[maxConfigParams];
+  Calibration calibration;
+  const uint8_t *classifierRle; // Points into the decoded buffer, null if not stored
+  size_t classifierRleLength;
+};
+
+// Returns bytes written, 0 if it doesn't fit. The classifier table is left out
+// (classifier = null or too big for the space left) without failing.
+size_t encodeConfig(const Parameter *table, int count, const Calibration &cal, const uint8_t *classifier,
+                    uint8_t *out, size_t capacity);
+// Checks magic, version, CRC and lengths
+bool decodeConfig(const uint8_t *in, size_t length, ConfigData &config);
+// Sets the stored values without calling changed(), returns how many applied
+int applyConfigParameters(const ConfigData &config, const Parameter *table, int count);
+// Expands the stored table into 'classifier' (65536 bits), false if none stored
+bool loadConfigClassifier(const ConfigData &config, uint8_t *classifier);
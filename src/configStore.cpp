@@ -0,0 +1,25 @@
+#include <configStore.h>
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <config.h>
+#include <protocol.h>
+
+size_t readConfigStore(uint8_t *buffer, size_t capacity) {
+  if (capacity < configHeaderSize) return 0;
+  for (size_t i = 0; i < configHeaderSize; i++) buffer[i] = EEPROM.read(i);
+  if (get32(buffer) != configMagic) return 0;
+
+  size_t length = configHeaderSize + get16(buffer + 6);
+  if (length > capacity || length > configStoreSize) return 0;
+  for (size_t i = configHeaderSize; i < length; i++) buffer[i] = EEPROM.read(i);
+  return length;
+}
+
+// update() skips bytes that are already right, saving flash wear
+void writeConfigStore(const uint8_t *data, size_t length) {
+  for (size_t i = 0; i < length && i < configStoreSize; i++) EEPROM.update(i, data[i]);
+}
+
+void eraseConfigStore() {
+  for (size_t i = 0; i < 4; i++) EEPROM.update(i, 0xFF); // Kill the magic
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// Saved configuration lives at the start of the Teensy's emulated EEPROM
+constexpr size_t configStoreSize = 4096; // Teensy 4.1 has 4284 bytes
+
+// Reads the stored blob, returns its length or 0 if nothing looks stored.
+// Only the header is read when the store is empty, so boot stays fast.
+size_t readConfigStore(uint8_t *buffer, size_t capacity);
+// Flash writes block for a while, call on request only, never per frame
+void writeConfigStore(const uint8_t *data, size_t length);
+void eraseConfigStore();
+
+// main.cpp, also reachable through MSG_CONFIG_COMMAND. saveConfig() returns bytes stored (0 = failed).
+uint32_t saveConfig();
+void eraseConfig();
@@ -0,0 +1,44 @@
+#pragma once
+#include <stdint.h>
+
+// Sensor output size. The mask, classifier loop, labeller and tracker are
+// instantiated per geometry so strides and loop bounds are constants.
+template <uint16_t W, uint16_t H>
+struct FrameGeometry {
+  static constexpr uint16_t width = W;
+  static constexpr uint16_t height = H;
+  static constexpr uint32_t pixels = uint32_t(W) * H;
+  static constexpr int maskBytes = (pixels + 7) / 8;
+  static constexpr uint32_t frameBytes = pixels * 2; // RGB565
+};
+
+using Frame160x120 = FrameGeometry<160, 120>;
+using Frame176x144 = FrameGeometry<176, 144>;
+using Frame320x240 = FrameGeometry<320, 240>;
+
+// Tuning in pixels (blob thresholds, calibration) is done at this size and
+// scaled to the active one. Buffers are sized for the largest.
+using ReferenceGeometry = Frame160x120;
+using MaxGeometry = Frame320x240;
+
+// Sensor-side crop (sensorWindow.h) read out while tracking, a quarter of the frame
+template <typename Geometry>
+using WindowGeometry = FrameGeometry<Geometry::width / 2, Geometry::height / 2>;
+
+// Runtime choice, selects the instance. Values are on the wire (parameters).
+enum Resolution : uint8_t {
+  RES_160x120,
+  RES_176x144,
+  RES_320x240,
+  RES_COUNT
+};
+
+struct FrameSize {
+  uint16_t width, height;
+};
+
+constexpr FrameSize resolutionSizes[RES_COUNT] = {
+  { Frame160x120::width, Frame160x120::height },
+  { Frame176x144::width, Frame176x144::height },
+  { Frame320x240::width, Frame320x240::height },
+};
@@ -0,0 +1,55 @@
+#include "kinematics.h"
+#include <cmath>
+
+constexpr float degToRad = 3.14159265f / 180.0f;
+constexpr float radToDeg = 180.0f / 3.14159265f;
+
+void initCameraModel(CameraModel &model, float hFovDeg, int width, int height) {
+  // Square pixels, principal point in the middle of the sensor
+  model.fx = (width * 0.5f) / std::tan(hFovDeg * 0.5f * degToRad);
+  model.fy = model.fx;
+  model.cx = (width - 1) * 0.5f;
+  model.cy = (height - 1) * 0.5f;
+  model.panCentre = 90.0f;
+  model.tiltCentre = 90.0f;
+  model.panSign = 1.0f;
+  model.tiltSign = 1.0f;
+}
+
+void scaleCameraModel(CameraModel &model, int fromWidth, int fromHeight, int toWidth, int toHeight) {
+  float sx = (float)toWidth / fromWidth;
+  float sy = (float)toHeight / fromHeight;
+  model.fx *= sx;
+  model.fy *= sy;
+  model.cx = (model.cx + 0.5f) * sx - 0.5f; // Pixel centres, not edges
+  model.cy = (model.cy + 0.5f) * sy - 0.5f;
+}
+
+void pixelToWorld(const CameraModel &model, float px, float py, float pan, float tilt,
+                  float &azimuth, float &elevation) {
+  float panAngle = (pan - model.panCentre) * model.panSign * degToRad;
+  float tiltAngle = (tilt - model.tiltCentre) * model.tiltSign * degToRad;
+
+  // Ray in camera coordinates (x right, y up, z forward)
+  float x = (px - model.cx) / model.fx;
+  float y = -(py - model.cy) / model.fy;
+  float z = 1.0f;
+
+  // Tilt about the camera x axis, then pan about the world vertical axis
+  float ct = std::cos(tiltAngle), st = std::sin(tiltAngle);
+  float y1 = y * ct + z * st;
+  float z1 = -y * st + z * ct;
+
+  float cp = std::cos(panAngle), sp = std::sin(panAngle);
+  float x2 = x * cp + z1 * sp;
+  float z2 = -x * sp + z1 * cp;
+
+  azimuth = std::atan2(x2, z2) * radToDeg;
+  elevation = std::atan2(y1, std::sqrt(x2 * x2 + z2 * z2)) * radToDeg;
+}
+
+// The optical axis points exactly at (pan angle, tilt angle), so this is just the inverse servo mapping
+void worldToServo(const CameraModel &model, float azimuth, float elevation, float &pan, float &tilt) {
+  pan = model.panCentre + azimuth / model.panSign;
+  tilt = model.tiltCentre + elevation / model.tiltSign;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+// Pinhole camera carried by the pan/tilt servos. World frame is fixed to the
+// mount: azimuth positive right, elevation positive up, both in degrees.
+struct CameraModel {
+  float fx, fy;              // Focal length (pixels)
+  float cx, cy;              // Principal point (pixels)
+  float panCentre, tiltCentre; // Servo angles that point the camera straight ahead
+  float panSign, tiltSign;   // +1 if increasing the servo angle turns the camera right/up
+};
+
+void initCameraModel(CameraModel &model, float hFovDeg, int width, int height);
+
+// Same camera at another output size, the sensor scaler keeps the field of view
+void scaleCameraModel(CameraModel &model, int fromWidth, int fromHeight, int toWidth, int toHeight);
+
+// Direction of a pixel in the world for the given servo pose
+void pixelToWorld(const CameraModel &model, float px, float py, float pan, float tilt,
+                  float &azimuth, float &elevation);
+
+// Servo pose that puts a world direction in the image centre
+void worldToServo(const CameraModel &model, float azimuth, float elevation, float &pan, float &tilt);
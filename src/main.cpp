@@ -1,17 +1,26 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include <string>
+#include <algorithm>
 #include <SPI.h>
 #include <ArduCAM.h>
 #include <memorysaver.h>
+#include <sensor.h>
 #include <Servo.h>
 #include <blobDetection.h>
 #include <camera.h>
+#include <telemetry.h>
+#include <servoControl.h>
+#include <kinematics.h>
+#include <calibration.h>
+#include <classifier.h>
+#include <params.h>
+#include <commands.h>
+#include <config.h>
+#include <configStore.h>
+#include <sensorWindow.h>
 #include <DMAChannel.h>
-
-#if !(defined (OV2640_MINI_2MP_PLUS))
-#error Enable OV2640_MINI_2MP_PLUS in memorysaver.h
-#endif
+#include <IntervalTimer.h>
 
 #define CS_PIN 10
 
@@ -23,8 +32,9 @@ double buffer capture and processing
 */
 
 // Camera module setup
-ArduCAM myCAM(OV2640, CS_PIN);
+ArduCAM myCAM(SENSOR_MODEL, CS_PIN);
 DMAMEM uint8_t mask[bitmaskSize]; // 1D bit array 
+FrameTiming frameTiming;
 
 // Debug
 //const uint32_t expectedLength = (pixelWidth * pixelHeight * 2) + 8;
@@ -34,48 +44,270 @@ TrackerState tracker;
 DMAMEM std::vector<Blob> blobs;
 bool targetSet = false;
 int persistanceFrames = 3;
+int persistanceLimit = 5; // Missed frames before the target is dropped
 
 // Servo paramters
 Servo SERVOH;
 Servo SERVOV;
 
-const int centerX = pixelWidth / 2;
-const int centerY = pixelHeight / 2;
-const int deadzone = 5;
-const float KpH = 0.1;
-const float KpV = 0.1;
+float deadzone = 0.4;  // Degrees, removed smoothly by the controller
+// PID gains on angular error, output is deg/s
+const float KpH = 10.0;
+const float KpV = 10.0;
+const float KiH = 0.5;
+const float KiV = 0.5;
+const float KdH = 0.12;
+const float KdV = 0.12;
+// Target angular velocity feedforward
+const float KffH = 0.8;
+const float KffV = 0.8;
 const bool invertX = true; 
 const bool invertY = false; 
-// Start position
-static int servoHPos = 90;
-static int servoVPos = 90;
+const float cameraHFov = 60.0; // Module lens horizontal field of view (degrees)
+const bool calibrateOnBoot = false; // Needs a static target in view at power up
+const uint32_t servoLatency = 20000; // micros until a new command takes effect (one 50Hz servo period)
+uint8_t aimPrediction = 1;           // Lead the target by the pipeline and servo latency, 0 aims at the last estimate
+const int servoRate = 200;           // Control loop rate (Hz), independent of frame rate
+const uint32_t cameraResetHold = 2;  // ms the ArduCAM CPLD is held in reset
+uint32_t setupMicros = 0;            // Time spent in setup(), reported with the first frame
+// Controller state, centred in setup(). Only the servo timer writes these.
+AxisController servoH;
+AxisController servoV;
+IntervalTimer servoTimer;
+CameraModel camera;
+Calibration calibration;
+
+// Vision loop -> servo timer
+TargetMailbox targetBox;
+uint32_t trackId = 0;
+float framePoseH = 90, framePoseV = 90; // Servo positions while the current frame was exposed
+
+// Output size per tracking state: small frames find the target faster, larger
+// ones give a finer centroid once locked. Switched between frames in loop().
+Resolution acquireResolution = RES_160x120;
+Resolution trackResolution = RES_160x120;
+Resolution activeResolution = RES_160x120; // What the sensor is producing
+
+// Sensor-side crop while tracking, see sensorWindow.h. The window follows the
+// target once it strays within windowMargin of an edge (a fraction of the window).
+uint8_t sensorWindowing = 0;
+const float windowMargin = 0.25f;
+SensorWindow activeWindow; // Disabled = whole frame
+
+// RGB565 or YUV422, switched between frames like the resolution
+CaptureFormat captureFormat = CAPTURE_RGB565;
+CaptureFormat activeFormat = CAPTURE_RGB565;
+
+// Sensor writes are queued in the driver and sent between frames, after the
+// last CAP_DONE and before the next trigger, so none reaches the sensor while
+// a frame is captured. Changes that alter the frame (resolution, window,
+// format) go one at a time; the pipeline switches over in their completion
+// callback, before the first new frame is triggered.
+const uint32_t vsyncGuard = 500;  // micros kept clear before the next VSYNC
+const int sensorQueueMaxWait = 3; // Frames before queued writes are forced out ahead of a capture
+bool sensorChangePending = false;
+Resolution pendingResolution = RES_160x120;
+SensorWindow pendingWindow;
+CaptureFormat pendingFormat = CAPTURE_RGB565;
+int sensorQueueWait = 0;
+
+// Sensor exposure. Auto exposure stretches frames in dim light and shifts the
+// colours under the classifier, a pinned short exposure keeps both steady.
+uint8_t autoExposure = 1;
+uint8_t autoGain = 1;
+int exposureLines = 300;   // Sensor line periods, manual only
+int sensorGain = 16;       // 1/16 steps, manual only
+uint8_t awbLock = 0;
+int clockDivider = 0;      // Sensor clock = XVCLK / (divider + 1)
+
+
+uint32_t classifierBuildMicros = 0; // Last rebuild
+
+void rebuildClassifier() {
+  uint32_t start = micros();
+  buildClassifier(colourThresholds);
+  classifierBuildMicros = micros() - start;
+}
 
+void applyDeadzone() {
+  servoH.deadband = servoV.deadband = deadzone;
+}
 
-void trackServo(Pixel p) {
-  if (p.x >= 0 && p.y >= 0) {
-      int errorX = p.x - centerX;
-      int errorY = p.y - centerY;
+void writeSensorControls() {
+  SensorControls controls;
+  controls.autoExposure = autoExposure;
+  controls.autoGain = autoGain;
+  controls.exposureLines = exposureLines;
+  controls.gain = sensorGain;
+  controls.awbLock = awbLock;
+  controls.clockDivider = clockDivider;
+  sensorSetControls(controls);
+}
 
-      if (invertX) errorX = -errorX;
-      if (invertY) errorY = -errorY;
+// The clock divider and exposure set the frame period, measure it again
+void sensorControlsApplied() {
+  sensorFramePeriod = 0;
+}
 
-      // Check for deviation
-      if (abs(errorX) > deadzone) {
-          servoHPos += errorX * KpH;
-          servoHPos = constrain(servoHPos, 0, 180);
-          SERVOH.write(servoHPos);
-      }
+// Queued, goes out ahead of a later frame (see startCapture())
+void applySensorControls() {
+  sensorBeginQueue();
+  writeSensorControls();
+  sensorEndQueue(sensorControlsApplied);
+}
+
+// Runtime tunables, see commands.h. Ids are part of the protocol, don't reuse them.
+// Gains point straight at the controllers (float stores are atomic for the servo timer).
+const Parameter parameters[] = {
+  { 1, "colour.rMin", PARAM_INT, &colourThresholds.rMin, 0, 255, rebuildClassifier },
+  { 2, "colour.rMax", PARAM_INT, &colourThresholds.rMax, 0, 256, rebuildClassifier },
+  { 3, "colour.gMin", PARAM_INT, &colourThresholds.gMin, 0, 255, rebuildClassifier },
+  { 4, "colour.gMax", PARAM_INT, &colourThresholds.gMax, 0, 256, rebuildClassifier },
+  { 5, "colour.bMin", PARAM_INT, &colourThresholds.bMin, 0, 255, rebuildClassifier },
+  { 6, "colour.bMax", PARAM_INT, &colourThresholds.bMax, 0, 256, rebuildClassifier },
+  { 7, "colour.maxGreenBlue", PARAM_INT, &colourThresholds.maxGreenBlue, 0, 256, rebuildClassifier },
+  { 10, "blobThreshold", PARAM_INT, &blobThreshold, 1, ReferenceGeometry::width, nullptr },
+  { 11, "blobMinPixels", PARAM_INT, &blobMinPixels, 0, 1000, nullptr },
+  { 12, "persistanceFrames", PARAM_INT, &persistanceLimit, 1, 100, nullptr },
+  { 20, "kpH", PARAM_FLOAT, &servoH.kp, 0, 100, nullptr },
+  { 21, "kpV", PARAM_FLOAT, &servoV.kp, 0, 100, nullptr },
+  { 22, "kiH", PARAM_FLOAT, &servoH.ki, 0, 20, nullptr },
+  { 23, "kiV", PARAM_FLOAT, &servoV.ki, 0, 20, nullptr },
+  { 24, "kdH", PARAM_FLOAT, &servoH.kd, 0, 5, nullptr },
+  { 25, "kdV", PARAM_FLOAT, &servoV.kd, 0, 5, nullptr },
+  { 26, "kffH", PARAM_FLOAT, &servoH.kff, 0, 2, nullptr },
+  { 27, "kffV", PARAM_FLOAT, &servoV.kff, 0, 2, nullptr },
+  { 28, "deadzone", PARAM_FLOAT, &deadzone, 0, 10, applyDeadzone },
+  { 29, "aimPrediction", PARAM_UINT8, &aimPrediction, 0, 1, nullptr },
+  { 30, "streamMode", PARAM_UINT8, &streamMode, STREAM_OFF, STREAM_ROI, restartStream },
+  { 31, "acquireResolution", PARAM_UINT8, &acquireResolution, RES_160x120, RES_COUNT - 1, nullptr },
+  { 32, "trackResolution", PARAM_UINT8, &trackResolution, RES_160x120, RES_COUNT - 1, nullptr },
+  { 33, "sensorWindow", PARAM_UINT8, &sensorWindowing, 0, 1, nullptr },
+  { 34, "captureFormat", PARAM_UINT8, &captureFormat, CAPTURE_RGB565, CAPTURE_YUV422, nullptr },
+  { 35, "blobsOut", PARAM_UINT8, &blobsOut, 0, 1, nullptr },
+  { 40, "chroma.yMin", PARAM_INT, &chromaThresholds.yMin, 0, 255, nullptr },
+  { 41, "chroma.yMax", PARAM_INT, &chromaThresholds.yMax, 0, 256, nullptr },
+  { 42, "chroma.uMin", PARAM_INT, &chromaThresholds.uMin, 0, 255, nullptr },
+  { 43, "chroma.uMax", PARAM_INT, &chromaThresholds.uMax, 0, 256, nullptr },
+  { 44, "chroma.vMin", PARAM_INT, &chromaThresholds.vMin, 0, 255, nullptr },
+  { 45, "chroma.vMax", PARAM_INT, &chromaThresholds.vMax, 0, 256, nullptr },
+  { 50, "sensor.autoExposure", PARAM_UINT8, &autoExposure, 0, 1, applySensorControls },
+  { 51, "sensor.exposure", PARAM_INT, &exposureLines, 1, 65535, applySensorControls },
+  { 52, "sensor.autoGain", PARAM_UINT8, &autoGain, 0, 1, applySensorControls },
+  { 53, "sensor.gain", PARAM_INT, &sensorGain, 16, 496, applySensorControls },
+  { 54, "sensor.awbLock", PARAM_UINT8, &awbLock, 0, 1, applySensorControls },
+  { 55, "sensor.clockDivider", PARAM_INT, &clockDivider, 0, 63, applySensorControls },
+};
+const int parameterCount = sizeof(parameters) / sizeof(parameters[0]);
+
+// Saved configuration, see config.h
+uint8_t configBuffer[configStoreSize];
+
+// Last saved calibration, parameters and classifier table. False leaves the
+// compiled defaults in place.
+bool loadConfig() {
+  ConfigData config;
+  size_t length = readConfigStore(configBuffer, sizeof(configBuffer));
+  if (!decodeConfig(configBuffer, length, config)) return false;
+
+  // Calibration schedules gains, saved gains override them
+  if (config.calibration.valid) {
+    calibration = config.calibration;
+    applyCalibration(calibration, camera, servoH, servoV);
+  }
+  applyConfigParameters(config, parameters, parameterCount);
+  applyDeadzone();
+  restartStream();
+  if (!loadConfigClassifier(config, classifierTable)) rebuildClassifier();
+  return true;
+}
+
+uint32_t saveConfig() {
+  size_t length = encodeConfig(parameters, parameterCount, calibration, classifierTable,
+                               configBuffer, sizeof(configBuffer));
+  if (length) writeConfigStore(configBuffer, length);
+  return length;
+}
+
+void eraseConfig() {
+  eraseConfigStore();
+}
 
-      if (abs(errorY) > deadzone) {
-          servoVPos += errorY * KpV;
-          servoVPos = constrain(servoVPos, 0, 180);
-          SERVOV.write(servoVPos);
+// Sensor registers as last written, straight from the driver's shadow (no I2C)
+void sendSensorState() {
+  uint8_t payload[1 + 32 + 256 + 12];
+  for (uint8_t bank = 0; bank < 2; bank++) {
+    memset(payload, 0, sizeof(payload));
+    payload[0] = bank;
+    for (int reg = 0; reg < 256; reg++) {
+      uint8_t value;
+      if (sensorRegister(bank, reg, value)) {
+        payload[1 + (reg >> 3)] |= 1 << (reg & 7);
+        payload[33 + reg] = value;
       }
     }
+    put32(payload + 289, sensorWritesSkipped());
+    put32(payload + 293, sensorBusWrites());
+    put32(payload + 297, sensorFramePeriod);
+    telemetrySend(MSG_SENSOR_STATE, 0, micros(), payload, sizeof(payload));
+  }
+}
+
+// Runs at servoRate from the timer interrupt. Never touches SPI, so the capture
+// path is only delayed by a few microseconds, never blocked.
+void trackServo() {
+  static uint32_t activeTrack = 0;
+  TargetSnapshot target = readTarget(targetBox);
+  if (!target.valid) return; // Hold position
+
+  if (target.track != activeTrack) {
+    resetAxis(servoH);
+    resetAxis(servoV);
+    activeTrack = target.track;
+  }
+
+  // The centroid is already one pipeline latency old, aim where the target
+  // will be once this command takes effect. Tracking is in world angles, so
+  // the camera moving since that frame doesn't affect the prediction.
+  float azimuth, elevation, pan, tilt;
+  uint32_t aimTime = aimPrediction ? micros() + servoLatency : target.tracker.lastTimestamp;
+  predictTarget(target.tracker, aimTime, azimuth, elevation);
+  worldToServo(camera, azimuth, elevation, pan, tilt);
+
+  float velH = target.tracker.velX / camera.panSign;
+  float velV = target.tracker.velY / camera.tiltSign;
+
+  const float dt = 1.0f / servoRate;
+  SERVOH.writeMicroseconds(degreesToMicroseconds(updateAxis(servoH, pan - servoH.position, velH, dt)));
+  SERVOV.writeMicroseconds(degreesToMicroseconds(updateAxis(servoV, tilt - servoV.position, velV, dt)));
 }
 
+void publishTracker(bool valid) {
+  TargetSnapshot snapshot;
+  snapshot.valid = valid;
+  snapshot.track = trackId;
+  snapshot.tracker = tracker;
+  publishTarget(targetBox, snapshot);
+}
+
+// Feed a centroid from the current frame to the world-angle motion estimate
+void updateTracker(float x, float y) {
+  float azimuth, elevation;
+  pixelToWorld(camera, x, y, framePoseH, framePoseV, azimuth, elevation);
+  updateTargetMotion(tracker, azimuth, elevation, frameTimestamp(frameTiming));
+}
+
+// New target from acquireFromBlobs(), restart motion and control
+void acquireTarget() {
+  trackId++;
+  resetTargetMotion(tracker);
+  updateTracker(tracker.lastCentroidX, tracker.lastCentroidY);
+  publishTracker(true);
+}
+
+template <typename Geometry>
 inline void setPixelMask(int x, int y, bool value) {
-  int bitIndex = y * pixelWidth + x;
+  int bitIndex = y * Geometry::width + x;
   int byteIndex = bitIndex / 8;
   int bitOffset = bitIndex % 8;
 
@@ -86,68 +318,160 @@ inline void setPixelMask(int x, int y, bool value) {
 }
 
 
-bool isTargetColour(uint16_t rgb565) {
-  uint8_t r = (rgb565 >> 11) & 0x1F;
-  uint8_t g = (rgb565 >> 5) & 0x3F;
-  uint8_t b = rgb565 & 0x1F;
-
-  r = (r * 255) / 31;
-  g = (g * 255) / 63;
-  b = (b * 255) / 31;
-
-  if ((r > 110 && r < 255) &&
-      (g > 0 && g < 60) &&
-      (b > 0 && b < 90)&&
-      (abs(g - b) < 30)) {
-    return true;
+// Stream in what was read out, window pixels when cropped
+void initializeStreamFrame() {
+  int targetX = -1, targetY = -1;
+  if (targetSet) {
+    float x = tracker.lastCentroidX, y = tracker.lastCentroidY;
+    frameToWindow(activeWindow, x, y);
+    targetX = x;
+    targetY = y;
   }
-  return false;
+  initializeFrame(targetX, targetY);
 }
 
+template <typename Geometry>
 void sendRGB565() {
-  initializeFrame();
+  initializeStreamFrame();
   // Read image pixel by pixel 
-  for (int y = 0; y < pixelHeight; y++) {
-    for (int x = 0; x < pixelWidth; x++) {
+  for (int y = 0; y < Geometry::height; y++) {
+    for (int x = 0; x < Geometry::width; x++) {
       // rgb565 format is 2 bytes long
       // The HI byte is the most important, containing 5 red bits and 3 green bits, LO 3 green and 5 blue
       // Each pixel is read byte by byte
-      uint8_t high = SPI.transfer(0x00);
-      uint8_t low = SPI.transfer(0x00);
+      uint8_t high = myCAM.transfer(0x00);
+      uint8_t low = myCAM.transfer(0x00);
       uint16_t pixel565 = (high << 8) | low;
 
-      setPixelMask(x, y, isTargetColour(pixel565));
+      setPixelMask<Geometry>(x, y, isTargetColour(pixel565));
       
-      readBytes(low, high);
+      streamPixel(x, y, low, high);
     }
+    endRow(y);
   }
 
-  flushBuffer();
-
   endFrame(); 
   
   myCAM.CS_HIGH(); 
+  frameTiming.readoutDone = micros();
   //Serial.println("\nImage sent!");
   yield();
 }
 
+// Y U Y V per pixel pair: the chroma test runs once per pair, Y gates each
+// pixel and lands in lumaPlane.
+template <typename Geometry>
+void sendYUV422() {
+  static_assert(Geometry::width % 2 == 0, "YUV422 needs whole pixel pairs");
+  initializeStreamFrame();
+  uint8_t *luma = lumaPlane;
+  for (int y = 0; y < Geometry::height; y++) {
+    for (int x = 0; x < Geometry::width; x += 2) {
+      uint8_t y0 = myCAM.transfer(0x00);
+      uint8_t u = myCAM.transfer(0x00);
+      uint8_t y1 = myCAM.transfer(0x00);
+      uint8_t v = myCAM.transfer(0x00);
+      *luma++ = y0;
+      *luma++ = y1;
+
+      bool chroma = isTargetChroma(u, v);
+      setPixelMask<Geometry>(x, y, chroma && isTargetLuma(y0));
+      setPixelMask<Geometry>(x + 1, y, chroma && isTargetLuma(y1));
+
+      if (frameQueued) {
+        uint16_t p0 = yuvToRgb565(y0, u, v);
+        uint16_t p1 = yuvToRgb565(y1, u, v);
+        streamPixel(x, y, p0 & 0xFF, p0 >> 8);
+        streamPixel(x + 1, y, p1 & 0xFF, p1 >> 8);
+      }
+    }
+    endRow(y);
+  }
+
+  endFrame();
+
+  myCAM.CS_HIGH();
+  frameTiming.readoutDone = micros();
+  yield();
+}
+
 
 
-void captureFrameWithThreshold() {
+// Startup cost, what a watchdog reset costs us in lost tracking
+void reportBootTime() {
+  Serial.print("First frame "); Serial.print(micros() / 1000);
+  Serial.print(" ms after reset, setup "); Serial.print(setupMicros / 1000); Serial.println(" ms");
+}
 
+// Time left before the next VSYNC, whole measured periods on from the last
+// CAP_DONE (which came at one). 0 if either is unknown. Writes sent within it
+// still let the trigger catch that VSYNC; a wrong estimate costs a frame, it
+// can't put a write inside one.
+uint32_t timeToVsync(uint32_t now) {
+  if (sensorFramePeriod == 0 || !frameTiming.captured) return 0;
+  uint32_t left = sensorFramePeriod - (now - frameTiming.captureDone) % sensorFramePeriod;
+  return left > vsyncGuard ? left - vsyncGuard : 0;
+}
+
+// Throwaway capture just ahead of this frame's, whose CAP_DONE marks a VSYNC
+// to measure the frame period from (see updateFramePeriod()). It costs a
+// frame, so it's only taken when the period is unknown and a write queue
+// needs it for its budget.
+void markFramePeriod() {
   myCAM.flush_fifo();
   myCAM.clear_fifo_flag();
   myCAM.start_capture();
+  uint32_t startTime = millis();
+  while (!myCAM.get_bit(ARDUCHIP_TRIG, CAP_DONE_MASK)) {
+    serviceTelemetry();
+    if (millis() - startTime > 2000) return;
+  }
+  framePeriodMark = micros();
+  delayMicroseconds(vsyncGuard); // Clear of the VSYNC that ended it
+}
+
+// Send queued sensor writes that fit before the next VSYNC, then start a
+// capture. Whatever doesn't fit waits for the next frame; writes stuck for
+// sensorQueueMaxWait frames go out regardless (the capture then starts a
+// frame later).
+void startCapture() {
+  bool queued = sensorQueuedGroups() > 0;
+  if (queued && sensorQueueWait >= sensorQueueMaxWait) sensorServiceQueue(UINT32_MAX);
+  else if (sensorQueuesWrites && sensorFramePeriod == 0) markFramePeriod();
+  else if (queued) sensorServiceQueue(timeToVsync(micros()));
+  sensorQueueWait = sensorQueuedGroups() > 0 ? sensorQueueWait + 1 : 0;
+
+  myCAM.flush_fifo();
+  myCAM.clear_fifo_flag();
+  frameTiming.frame++;
+  frameTiming.captureStart = micros();
+  framePoseH = servoH.actual;
+  framePoseV = servoV.actual;
+  myCAM.start_capture();
   //Serial.println("Capturing...");
+}
 
+// False if CAP_DONE never came, the frame is then marked as not captured
+template <typename Geometry>
+bool captureFrameWithThreshold() {
   // Wait until capture is done
   uint32_t startTime = millis();
   while (!myCAM.get_bit(ARDUCHIP_TRIG, CAP_DONE_MASK)) {
+    serviceTelemetry(); // Sensor is exposing, use the slack to drain serial
     if (millis() - startTime > 2000) {
       //Serial.println("Capture timeout.");
-      return;
+      frameTiming.captured = false;
+      framePeriodMark = 0; // Measured again next time
+      frameTiming.captureDone = frameTiming.readoutDone = micros(); // Keep the timing deltas sane
+      return false;
     }
   }
+  frameTiming.captured = true;
+  frameTiming.captureDone = micros();
+  updateFramePeriod(frameTiming);
+  if (frameTiming.frame == 1) reportBootTime();
+  framePoseH = (framePoseH + servoH.actual) * 0.5f;
+  framePoseV = (framePoseV + servoV.actual) * 0.5f;
 
   //Serial.println("Capture done!");
   /*
@@ -161,90 +485,312 @@ void captureFrameWithThreshold() {
 
   myCAM.CS_LOW();
   myCAM.set_fifo_burst();
-  sendRGB565();
-  //printMask(); // Needed for getMask.py, can be commented out
-  delay(20);  // Optional pacing
+  if (activeFormat == CAPTURE_YUV422) sendYUV422<Geometry>();
+  else sendRGB565<Geometry>();
+  sendMask(); // Needed for getMask.py, enable with maskOut
+  return true;
+}
+
+// A timed out capture leaves no blobs, the tracker counts it as a missed frame.
+// Scale is the frame Geometry's pixels belong to (see detectBlobs).
+template <typename Geometry, typename Scale = Geometry>
+void captureAndDetect() {
+  if (captureFrameWithThreshold<Geometry>()) detectBlobs<Geometry, Scale>(mask, blobs);
+  else blobs.clear();
+  frameTiming.detectDone = micros();
+}
+
+// Whole frame or the sensor window, blobs always come out in frame pixels
+template <typename Geometry>
+void captureAndDetectAt() {
+  if (activeWindow.enabled) {
+    captureAndDetect<WindowGeometry<Geometry>, Geometry>();
+    windowToFrame(activeWindow, blobs);
+  } else {
+    captureAndDetect<Geometry>();
+  }
+}
+
+// Runtime resolution -> compiled pipeline instance. startCapture() may switch
+// it, so it's read afterwards.
+void captureAndDetect() {
+  startCapture();
+  switch (activeResolution) {
+    case RES_176x144: captureAndDetectAt<Frame176x144>(); break;
+    case RES_320x240: captureAndDetectAt<Frame320x240>(); break;
+    default: captureAndDetectAt<Frame160x120>(); break;
+  }
+}
+
+void acquireFromBlobs() {
+  switch (activeResolution) {
+    case RES_176x144: setCurrentTarget<Frame176x144>(blobs, targetSet, tracker); break;
+    case RES_320x240: setCurrentTarget<Frame320x240>(blobs, targetSet, tracker); break;
+    default: setCurrentTarget<Frame160x120>(blobs, targetSet, tracker); break;
+  }
+}
+
+Pixel trackTarget() {
+  switch (activeResolution) {
+    case RES_176x144: return trackBlob<Frame176x144>(blobs, blobThreshold, tracker);
+    case RES_320x240: return trackBlob<Frame320x240>(blobs, blobThreshold, tracker);
+    default: return trackBlob<Frame160x120>(blobs, blobThreshold, tracker);
+  }
+}
+
+// Queue a frame-changing write, done() switches the pipeline once it's out
+void queueSensorChange(void (*write)(), void (*done)()) {
+  sensorBeginQueue();
+  write();
+  sensorChangePending = true;
+  if (!sensorEndQueue(done)) sensorChangePending = false; // Queue full, retried next frame
+}
+
+// Pixel state (camera model, last centroid) moves to the new size,
+// world-angle motion carries over untouched
+void resolutionApplied() {
+  FrameSize from = resolutionSizes[activeResolution];
+  FrameSize to = resolutionSizes[pendingResolution];
+  scaleCameraModel(camera, from.width, from.height, to.width, to.height);
+  rescaleTracker(tracker, from, to);
+  setFrameGeometry(to.width, to.height);
+  activeResolution = pendingResolution;
+  activeWindow = SensorWindow();
+  sensorChangePending = false;
+}
+
+void writeResolution() {
+  sensorSetGeometry(pendingResolution); // Also restores the full window
+  writeSensorControls(); // In case the sensor timing was reloaded
+}
+
+void selectResolution(Resolution resolution) {
+  if (resolution >= RES_COUNT || resolution == activeResolution || sensorChangePending) return;
+  pendingResolution = resolution;
+  queueSensorChange(writeResolution, resolutionApplied);
+}
+
+void formatApplied() {
+  activeFormat = pendingFormat;
+  sensorChangePending = false;
 }
 
+void writeFormat() {
+  sensorSetFormat(pendingFormat);
+}
+
+void selectFormat(CaptureFormat format) {
+  if (format == activeFormat || sensorChangePending) return;
+  pendingFormat = format;
+  queueSensorChange(writeFormat, formatApplied);
+}
+
+void windowApplied() {
+  FrameSize frame = resolutionSizes[activeResolution];
+  activeWindow = pendingWindow;
+  if (activeWindow.enabled) setFrameGeometry(activeWindow.width, activeWindow.height);
+  else setFrameGeometry(frame.width, frame.height);
+  sensorChangePending = false;
+}
+
+void writeWindow() {
+  sensorSetWindow(pendingWindow, resolutionSizes[activeResolution]);
+}
+
+// Crop the sensor around the target while tracking, whole frame otherwise.
+// The window only moves when the target nears its edge, each move is ~10
+// register writes and restarts the compressed stream.
+void updateSensorWindow() {
+  if (sensorChangePending) return;
+  FrameSize frame = resolutionSizes[activeResolution];
+  SensorWindow window;
+  if (sensorWindowing && sensorCanWindow && targetSet && tracker.lastCentroidX >= 0) {
+    float x = tracker.lastCentroidX, y = tracker.lastCentroidY;
+    FrameSize size = { (uint16_t)(frame.width / 2), (uint16_t)(frame.height / 2) };
+    if (insideWindow(activeWindow, x, y, size.width * windowMargin)) return;
+    placeSensorWindow(window, frame, size, x, y);
+  }
+  if (!window.enabled && !activeWindow.enabled) return;
+
+  pendingWindow = window;
+  queueSensorChange(writeWindow, windowApplied);
+}
+
+// What the detector, tracker and servo loop decided this frame
+void recordFrame() {
+  FrameRecord record;
+  record.frame = frameTiming.frame;
+  record.captureStart = frameTiming.captureStart;
+  record.captureMicros = frameTiming.captureDone - frameTiming.captureStart;
+  record.readoutMicros = frameTiming.readoutDone - frameTiming.captureDone;
+  record.detectMicros = frameTiming.detectDone - frameTiming.readoutDone;
+  record.trackMicros = frameTiming.processDone - frameTiming.detectDone;
+  record.flags = (targetSet ? RECORD_TARGET_SET : 0) | (tracker.motionValid ? RECORD_MOTION_VALID : 0);
+  record.blobCount = std::min<size_t>(blobs.size(), 255);
+  record.targetX = targetSet ? tracker.lastCentroidX : -1;
+  record.targetY = targetSet ? tracker.lastCentroidY : -1;
+  record.azimuth = tracker.posX;
+  record.elevation = tracker.posY;
+  record.velAzimuth = tracker.velX;
+  record.velElevation = tracker.velY;
+  record.panCommand = servoH.position;
+  record.tiltCommand = servoV.position;
+  record.panActual = servoH.actual;
+  record.tiltActual = servoV.actual;
+  record.listed = std::min<size_t>(blobs.size(), maxRecordBlobs);
+  for (int i = 0; i < record.listed; i++) {
+    const Blob &blob = blobs[i];
+    record.blobs[i] = { (uint16_t)blob.minX, (uint16_t)blob.maxX, (uint16_t)blob.minY, (uint16_t)blob.maxY,
+                        blob.centreX, blob.centreY, (uint16_t)blob.pixelCount };
+  }
+  sendFrameRecord(record);
+}
+
+void finishFrame() {
+  if (!frameTiming.captured) return; // Capture timed out, nothing to report
+  frameTiming.processDone = micros();
+  sendStats(frameTiming);
+  recordFrame();
+}
+
+// Calibration hooks, the servo timer is idle until a target is published
+bool measureTarget(float &x, float &y, uint32_t &timestamp) {
+  captureAndDetect();
+  if (blobs.empty()) return false;
+
+  const Blob &largest = *std::max_element(blobs.begin(), blobs.end(),
+      [](const Blob &a, const Blob &b) { return a.pixelCount < b.pixelCount; });
+  x = largest.centreX;
+  y = largest.centreY;
+  timestamp = frameTimestamp(frameTiming);
+  return true;
+}
+
+void moveServo(int axis, float degrees) {
+  if (axis == 0) {
+    setAxisPosition(servoH, degrees);
+    SERVOH.writeMicroseconds(degreesToMicroseconds(servoH.position));
+  } else {
+    setAxisPosition(servoV, degrees);
+    SERVOV.writeMicroseconds(degreesToMicroseconds(servoV.position));
+  }
+}
+
+uint32_t calibrationClock() {
+  return micros();
+}
+
+void calibrate() {
+  CalibrationIO io = { measureTarget, moveServo, calibrationClock };
+  if (runCalibration(io, 90, 90, calibration)) {
+    applyCalibration(calibration, camera, servoH, servoV);
+    saveConfig(); // Next boot goes straight to tracking
+    Serial.print("Calibrated px/deg: "); Serial.print(calibration.pixelsPerDegreeX);
+    Serial.print(", "); Serial.print(calibration.pixelsPerDegreeY);
+    Serial.print(" lag: "); Serial.print(calibration.lagH, 3);
+    Serial.print(", "); Serial.println(calibration.lagV, 3);
+  } else {
+    Serial.println("Calibration failed, using defaults");
+  }
+}
 
 void setup() {
-  uint8_t vid, pid;
+  uint32_t setupStart = micros();
+  uint16_t sensorId;
   uint8_t temp;
 
   SERVOH.attach(15);
   SERVOV.attach(14);
+  initAxis(servoH, KpH, KiH, KdH, KffH, 90);
+  initAxis(servoV, KpV, KiV, KdV, KffV, 90);
+  applyDeadzone();
+  initCameraModel(camera, cameraHFov, ReferenceGeometry::width, ReferenceGeometry::height);
+  // invertX: increasing the pan angle moves the target right in the image, i.e. camera turns left
+  camera.panSign = invertX ? -1.0f : 1.0f;
+  camera.tiltSign = invertY ? 1.0f : -1.0f;
+  bool configLoaded = loadConfig();
+  if (!configLoaded) rebuildClassifier();
+  SERVOH.writeMicroseconds(degreesToMicroseconds(servoH.position));
+  SERVOV.writeMicroseconds(degreesToMicroseconds(servoV.position));
+  servoTimer.begin(trackServo, 1000000 / servoRate);
+  servoTimer.priority(192); // Below USB and other system interrupts
 
   Wire.begin();
+  Wire.setClock(400000); // SCCB handles fast mode, register tables load ~4x quicker
   Serial.begin(921600);
-  delay(100);
-  
+  initCommands();
+
+  Serial.println(configLoaded ? "Saved config loaded" : "No saved config, using defaults");
+  if (classifierBuildMicros) {
+    Serial.print("Classifier table built in "); Serial.print(classifierBuildMicros); Serial.println(" us");
+  }
   Serial.println("Camera start");
 
   pinMode(CS_PIN, OUTPUT);
   digitalWrite(CS_PIN, HIGH);
 
   SPI.begin();
-  delay(50);
 
-  // Reset camera
+  // Reset camera, then poll the SPI test register until the CPLD answers
   myCAM.write_reg(0x07, 0x80);
-  delay(100);
+  delay(cameraResetHold);
   myCAM.write_reg(0x07, 0x00);
-  delay(100);
 
   // Test SPI
+  uint32_t spiStart = millis();
   while (true) {
     myCAM.write_reg(ARDUCHIP_TEST1, 0x55);
     temp = myCAM.read_reg(ARDUCHIP_TEST1);
     if (temp == 0x55) break;
-    Serial.println("SPI interface error");
-    delay(100);
+    if (millis() - spiStart > 1000) {
+      Serial.println("SPI interface error");
+      spiStart = millis();
+    }
+    delayMicroseconds(200);
   }
 
-  // Check if the camera module type is OV2640
-  myCAM.rdSensorReg8_8(0x0A, &vid);
-  myCAM.rdSensorReg8_8(0x0B, &pid);
-  Serial.print("VID: 0x"); Serial.println(vid, HEX);
-  Serial.print("PID: 0x"); Serial.println(pid, HEX);
-  myCAM.wrSensorReg8_8(0xff, 0x01);
-  myCAM.rdSensorReg8_8(OV2640_CHIPID_HIGH, &vid);
-  myCAM.rdSensorReg8_8(OV2640_CHIPID_LOW, &pid);
-  if ((vid != 0x26) || ((pid != 0x42) && (pid != 0x41))) {
-    Serial.println("Can't find OV2640 module!");
+  // Check the module is the sensor this build is for (see sensor.h)
+  bool detected = sensorDetect(sensorId);
+  Serial.print("Sensor ID: 0x"); Serial.println(sensorId, HEX);
+  if (!detected) {
+    Serial.print("Can't find "); Serial.print(sensorName); Serial.println(" module!");
     while (1);
   } else {
-    Serial.println("OV2640 detected.");
+    Serial.print(sensorName); Serial.println(" detected.");
   }
 
   // Initialize camera
-  myCAM.set_format(BMP);
-  myCAM.InitCAM();
-  //myCAM.OV2640_set_Brightness(Brightness2);
-  //myCAM.OV2640_set_Color_Saturation(2);
-  //myCAM.OV2640_set_Light_Mode(Auto);
-  //myCAM.OV2640_set_Contrast(1);
-  myCAM.OV2640_set_JPEG_size(OV2640_160x120);
+  sensorInit();
+  sensorSetGeometry(activeResolution); // Calibration is at ReferenceGeometry
+  writeSensorControls();
   myCAM.clear_fifo_flag();
+  Serial.print("Sensor writes: "); Serial.print(sensorBusWrites());
+  Serial.print(", skipped by shadow: "); Serial.println(sensorWritesSkipped());
+
+  setupMicros = micros() - setupStart;
 
-  delay(10);
+  if (calibrateOnBoot && !calibration.valid) calibrate();
 }
 
 void loop() {
   //delay(2000);
+  selectResolution(targetSet ? trackResolution : acquireResolution);
+  updateSensorWindow();
+  selectFormat(captureFormat);
   if (!targetSet) {
-        captureFrameWithThreshold();
-        detectBlobs(pixelHeight, pixelWidth, mask, blobs);
-        setCurrentTarget(blobs, targetSet, tracker);
+        captureAndDetect();
+        acquireFromBlobs();
 
         if (targetSet) {
-            persistanceFrames = 5;
+            persistanceFrames = persistanceLimit;
+            acquireTarget();
         }
+        finishFrame();
     } 
     else {
-        captureFrameWithThreshold();
-        detectBlobs(pixelHeight, pixelWidth, mask, blobs);
+        captureAndDetect();
 
-        Pixel p = trackBlob(blobs, blobThreshold, tracker);
+        Pixel p = trackTarget();
 
         //Serial.print("X:");
         //Serial.print(p.x);
@@ -254,17 +800,29 @@ void loop() {
         if (p.x == -1 && p.y == -1) {
             persistanceFrames--;
             if (persistanceFrames > 0) {
-                captureFrameWithThreshold();
-                detectBlobs(pixelHeight, pixelWidth, mask, blobs);
-                setCurrentTarget(blobs, targetSet, tracker);
+                finishFrame(); // Record the missed frame before capturing the next
+                captureAndDetect();
+                acquireFromBlobs();
+                if (targetSet) {
+                    acquireTarget();
+                } else {
+                    publishTracker(false);
+                }
             } else {
                 targetSet = false;
+                resetTargetMotion(tracker);
+                publishTracker(false);
             }
         } 
         else {
             yield();
-            trackServo(p);
-            persistanceFrames = 5; // Reset if tracking successful
+            if (!tracker.motionValid) trackId++; // trackBlob() switched to a different blob
+            updateTracker(p.x, p.y);
+            publishTracker(true);
+            persistanceFrames = persistanceLimit; // Reset if tracking successful
         }
+        finishFrame();
     }
-}
\ No newline at end of file
+    serviceTelemetry();
+    serviceCommands();
+}
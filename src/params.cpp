@@ -0,0 +1,30 @@
+#include "params.h"
+#include <math.h>
+
+const Parameter *findParameter(const Parameter *table, int count, uint8_t id) {
+  for (int i = 0; i < count; i++) {
+    if (table[i].id == id) return &table[i];
+  }
+  return nullptr;
+}
+
+float getParameter(const Parameter &p) {
+  switch (p.type) {
+    case PARAM_INT: return *(int *)p.value;
+    case PARAM_FLOAT: return *(float *)p.value;
+    case PARAM_UINT8: return *(uint8_t *)p.value;
+  }
+  return 0;
+}
+
+bool setParameter(const Parameter &p, float value, bool notify) {
+  if (!(value >= p.min && value <= p.max)) return false; // Also rejects NaN
+
+  switch (p.type) {
+    case PARAM_INT: *(int *)p.value = lroundf(value); break;
+    case PARAM_FLOAT: *(float *)p.value = value; break;
+    case PARAM_UINT8: *(uint8_t *)p.value = lroundf(value); break;
+  }
+  if (notify && p.changed) p.changed();
+  return true;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <stdint.h>
+
+enum ParamType : uint8_t {
+  PARAM_INT = 0,   // int
+  PARAM_FLOAT = 1, // float
+  PARAM_UINT8 = 2, // uint8_t (and uint8_t enums)
+};
+
+// A tunable reachable from the command channel. Values travel as float, which
+// is exact for every integer parameter we have.
+struct Parameter {
+  uint8_t id;       // Stable across firmware versions, used on the wire
+  const char *name;
+  ParamType type;
+  void *value;
+  float min, max;   // Inclusive
+  void (*changed)(); // After a successful set, may be null
+};
+
+// The firmware's table (main.cpp)
+extern const Parameter parameters[];
+extern const int parameterCount;
+
+const Parameter *findParameter(const Parameter *table, int count, uint8_t id);
+float getParameter(const Parameter &p);
+// False if out of range, the value is left unchanged. notify = false skips the
+// changed() hook, for restoring a batch of values before applying them once.
+bool setParameter(const Parameter &p, float value, bool notify = true);
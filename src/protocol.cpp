@@ -0,0 +1,308 @@
+#include "protocol.h"
+#include <string.h>
+#include <stdlib.h>
+
+enum ParserState : uint8_t {
+  stateHeader,
+  statePayload,
+  stateTrailer,
+};
+
+// Reflected CRC-32 (IEEE 802.3, same as zlib/binascii.crc32), nibble table to keep flash small
+static const uint32_t crcTable[16] = {
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t length) {
+  crc = ~crc;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    crc = (crc >> 4) ^ crcTable[crc & 0x0F];
+    crc = (crc >> 4) ^ crcTable[crc & 0x0F];
+  }
+  return ~crc;
+}
+
+void encodeHeader(uint8_t *out, const MessageHeader &header) {
+  out[0] = protocolMagic0;
+  out[1] = protocolMagic1;
+  out[2] = header.type;
+  out[3] = header.flags;
+  put16(out + 4, header.seq);
+  put32(out + 6, header.length);
+  put32(out + 10, header.timestamp);
+  put16(out + 14, crc32(out, 14) & 0xFFFF);
+}
+
+bool decodeHeader(const uint8_t *in, MessageHeader &header) {
+  if (in[0] != protocolMagic0 || in[1] != protocolMagic1) return false;
+  if (get16(in + 14) != (crc32(in, 14) & 0xFFFF)) return false;
+
+  header.type = in[2];
+  header.flags = in[3];
+  header.seq = get16(in + 4);
+  header.length = get32(in + 6);
+  header.timestamp = get32(in + 10);
+  return header.length <= maxPayloadSize;
+}
+
+size_t encodeMessage(uint8_t *out, const MessageHeader &header, const uint8_t *payload) {
+  encodeHeader(out, header);
+  memcpy(out + headerSize, payload, header.length);
+  put32(out + headerSize + header.length, crc32(payload, header.length));
+  return headerSize + header.length + trailerSize;
+}
+
+static size_t putVarint(uint8_t *out, size_t position, size_t capacity, uint32_t value) {
+  do {
+    if (position >= capacity) return 0;
+    uint8_t byte = value & 0x7F;
+    value >>= 7;
+    out[position++] = value ? (byte | 0x80) : byte;
+  } while (value);
+  return position;
+}
+
+size_t encodeMaskRle(const uint8_t *mask, uint32_t bits, uint8_t *out, size_t capacity) {
+  size_t position = 0;
+  uint8_t current = 0;
+  uint32_t run = 0;
+  for (uint32_t i = 0; i < bits; i++) {
+    uint8_t bit = (mask[i >> 3] >> (i & 7)) & 1;
+    if (bit != current) {
+      position = putVarint(out, position, capacity, run);
+      if (position == 0) return 0;
+      current = bit;
+      run = 0;
+    }
+    run++;
+  }
+  return putVarint(out, position, capacity, run);
+}
+
+bool decodeMaskRle(const uint8_t *in, size_t length, uint8_t *mask, uint32_t bits) {
+  memset(mask, 0, (bits + 7) / 8);
+  uint32_t bit = 0;
+  uint8_t current = 0;
+  size_t i = 0;
+  while (i < length) {
+    uint32_t run = 0;
+    int shift = 0;
+    do {
+      if (i >= length || shift > 28) return false;
+      run |= (uint32_t)(in[i] & 0x7F) << shift;
+      shift += 7;
+    } while (in[i++] & 0x80);
+
+    if (run > bits - bit) return false;
+    if (current) {
+      for (uint32_t k = bit; k < bit + run; k++) mask[k >> 3] |= 1 << (k & 7);
+    }
+    bit += run;
+    current ^= 1;
+  }
+  return bit == bits;
+}
+
+size_t encodeFrameRecord(uint8_t *out, const FrameRecord &record) {
+  put32(out, record.frame);
+  put32(out + 4, record.captureStart);
+  put32(out + 8, record.captureMicros);
+  put32(out + 12, record.readoutMicros);
+  put32(out + 16, record.detectMicros);
+  put32(out + 20, record.trackMicros);
+  out[24] = record.flags;
+  out[25] = record.blobCount;
+  put16(out + 26, (uint16_t)record.targetX);
+  put16(out + 28, (uint16_t)record.targetY);
+  putFloat(out + 30, record.azimuth);
+  putFloat(out + 34, record.elevation);
+  putFloat(out + 38, record.velAzimuth);
+  putFloat(out + 42, record.velElevation);
+  putFloat(out + 46, record.panCommand);
+  putFloat(out + 50, record.tiltCommand);
+  putFloat(out + 54, record.panActual);
+  putFloat(out + 58, record.tiltActual);
+
+  uint8_t listed = record.listed > maxRecordBlobs ? maxRecordBlobs : record.listed;
+  out[62] = listed;
+  uint8_t *blob = out + frameRecordFixedSize;
+  for (int i = 0; i < listed; i++, blob += recordBlobSize) {
+    const BlobSummary &b = record.blobs[i];
+    put16(blob, b.minX);
+    put16(blob + 2, b.maxX);
+    put16(blob + 4, b.minY);
+    put16(blob + 6, b.maxY);
+    put16(blob + 8, (uint16_t)(b.centreX * 16.0f + 0.5f));
+    put16(blob + 10, (uint16_t)(b.centreY * 16.0f + 0.5f));
+    put16(blob + 12, b.pixelCount);
+  }
+  return frameRecordFixedSize + listed * recordBlobSize;
+}
+
+bool decodeFrameRecord(const uint8_t *in, size_t length, FrameRecord &record) {
+  if (length < frameRecordFixedSize) return false;
+  record.frame = get32(in);
+  record.captureStart = get32(in + 4);
+  record.captureMicros = get32(in + 8);
+  record.readoutMicros = get32(in + 12);
+  record.detectMicros = get32(in + 16);
+  record.trackMicros = get32(in + 20);
+  record.flags = in[24];
+  record.blobCount = in[25];
+  record.targetX = (int16_t)get16(in + 26);
+  record.targetY = (int16_t)get16(in + 28);
+  record.azimuth = getFloat(in + 30);
+  record.elevation = getFloat(in + 34);
+  record.velAzimuth = getFloat(in + 38);
+  record.velElevation = getFloat(in + 42);
+  record.panCommand = getFloat(in + 46);
+  record.tiltCommand = getFloat(in + 50);
+  record.panActual = getFloat(in + 54);
+  record.tiltActual = getFloat(in + 58);
+  record.listed = in[62];
+  if (record.listed > maxRecordBlobs || length != frameRecordFixedSize + record.listed * recordBlobSize) {
+    return false;
+  }
+
+  const uint8_t *blob = in + frameRecordFixedSize;
+  for (int i = 0; i < record.listed; i++, blob += recordBlobSize) {
+    BlobSummary &b = record.blobs[i];
+    b.minX = get16(blob);
+    b.maxX = get16(blob + 2);
+    b.minY = get16(blob + 4);
+    b.maxY = get16(blob + 6);
+    b.centreX = get16(blob + 8) / 16.0f;
+    b.centreY = get16(blob + 10) / 16.0f;
+    b.pixelCount = get16(blob + 12);
+  }
+  return true;
+}
+
+static inline bool similar565(uint16_t a, uint16_t b, int tolerance) {
+  if (a == b) return true;
+  int dr = (a >> 11) - (b >> 11);
+  int dg = ((a >> 5) & 0x3F) - ((b >> 5) & 0x3F);
+  int db = (a & 0x1F) - (b & 0x1F);
+  return abs(dr) <= tolerance && abs(dg) <= tolerance && abs(db) <= tolerance;
+}
+
+size_t encodeDeltaRow(const uint16_t *row, uint16_t *previous, int width, int tolerance, uint8_t *out) {
+  size_t position = 0;
+  int x = 0;
+  while (x < width) {
+    int run = 0;
+    if (similar565(row[x], previous[x], tolerance)) {
+      // Unchanged run, 'previous' keeps the value the decoder has
+      while (x + run < width && run < 128 && similar565(row[x + run], previous[x + run], tolerance)) run++;
+      out[position++] = 0x80 | (run - 1);
+    } else {
+      // Literal run until the next unchanged word
+      while (x + run < width && run < 128 && !similar565(row[x + run], previous[x + run], tolerance)) run++;
+      out[position++] = run - 1;
+      for (int i = x; i < x + run; i++) {
+        put16(out + position, row[i] ^ previous[i]);
+        previous[i] = row[i];
+        position += 2;
+      }
+    }
+    x += run;
+  }
+  return position;
+}
+
+bool decodeDeltaFrame(const uint8_t *in, size_t length, uint16_t *frame, int width, int height) {
+  uint32_t pixels = width * height;
+  uint32_t p = 0;
+  size_t i = 0;
+  while (i < length) {
+    uint8_t control = in[i++];
+    uint32_t run = (control & 0x7F) + 1;
+    if (run > pixels - p) return false;
+    if (control & 0x80) {
+      p += run;
+    } else {
+      if (i + run * 2 > length) return false;
+      for (uint32_t k = 0; k < run; k++, i += 2) frame[p++] ^= get16(in + i);
+    }
+  }
+  return p == pixels;
+}
+
+void initParser(StreamParser &parser, uint8_t *payload, uint32_t capacity) {
+  memset(&parser, 0, sizeof(parser));
+  parser.payload = payload;
+  parser.capacity = capacity;
+  parser.state = stateHeader;
+}
+
+// Rejected header: a real one may start inside it, keep everything from the next magic byte
+static void resync(StreamParser &parser) {
+  for (;;) {
+    uint32_t k = 1;
+    while (k < parser.received && parser.header[k] != protocolMagic0) k++;
+    parser.skippedBytes += k;
+    memmove(parser.header, parser.header + k, parser.received - k);
+    parser.received -= k;
+    if (parser.received < 2 || parser.header[1] == protocolMagic1) return;
+  }
+}
+
+size_t parseStream(StreamParser &parser, const uint8_t *data, size_t length, bool &complete) {
+  complete = false;
+  size_t i = 0;
+
+  while (i < length) {
+    if (parser.state == stateHeader) {
+      uint8_t value = data[i++];
+      if ((parser.received == 0 && value != protocolMagic0) ||
+          (parser.received == 1 && value != protocolMagic1)) {
+        parser.skippedBytes++;
+        parser.received = 0;
+        if (value != protocolMagic0) continue;
+      }
+      parser.header[parser.received++] = value;
+
+      if (parser.received == headerSize) {
+        if (!decodeHeader(parser.header, parser.current)) {
+          resync(parser);
+          continue;
+        }
+        parser.received = 0;
+        parser.crc = 0;
+        parser.state = parser.current.length > 0 ? statePayload : stateTrailer;
+      }
+    } else if (parser.state == statePayload) {
+      // Copy as much of the payload as is available in one go
+      size_t n = parser.current.length - parser.received;
+      if (n > length - i) n = length - i;
+      if (parser.current.length <= parser.capacity) {
+        memcpy(parser.payload + parser.received, data + i, n);
+      }
+      parser.crc = crc32Update(parser.crc, data + i, n);
+      parser.received += n;
+      i += n;
+      if (parser.received == parser.current.length) {
+        parser.received = 0;
+        parser.state = stateTrailer;
+      }
+    } else {
+      parser.header[parser.received++] = data[i++];
+      if (parser.received == trailerSize) {
+        parser.received = 0;
+        parser.state = stateHeader;
+        if (get32(parser.header) != parser.crc) {
+          parser.crcErrors++;
+        } else if (parser.current.length > parser.capacity) {
+          parser.oversized++;
+        } else {
+          parser.messages++;
+          complete = true;
+          return i;
+        }
+      }
+    }
+  }
+  return i;
+}
@@ -0,0 +1,201 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// Serial stream framing, shared by the firmware and host tools.
+//
+// Every message is a 16 byte header, the payload and a CRC32 of the payload:
+//   0  magic     0xA5 0x5A
+//   2  type      MessageType
+//   3  flags     Type specific
+//   4  seq       uint16, increments per message (gaps = dropped messages)
+//   6  length    uint32, payload bytes
+//   10 timestamp uint32, micros() on the device
+//   14 headerCrc uint16, low half of CRC32 over bytes 0-13
+// All fields little-endian. The header CRC rejects magic bytes that happen to
+// appear in pixel data, and the length lets a receiver jump straight to the
+// next header instead of scanning for markers.
+constexpr uint8_t protocolMagic0 = 0xA5;
+constexpr uint8_t protocolMagic1 = 0x5A;
+constexpr uint32_t headerSize = 16;
+constexpr uint32_t trailerSize = 4;
+constexpr uint32_t maxPayloadSize = 1 << 20; // Anything larger is a corrupt header
+
+enum MessageType : uint8_t {
+  MSG_RAW_FRAME = 1, // uint16 width, uint16 height, RGB565 pixels (little-endian)
+  MSG_MASK = 2,      // uint16 width, uint16 height, packed mask bits (LSB first) or MASK_RLE runs
+  MSG_BLOBS = 3,     // FrameRecord
+  MSG_STATS = 4,     // uint32 captureStart, captureDone, processDone, dropped messages, last streamed frame bytes, preview decimation
+  MSG_DELTA_FRAME = 5, // uint16 width, uint16 height, delta rows (see encodeDeltaRow)
+  MSG_ROI_FRAME = 6,   // uint16 frame width, frame height, originX, originY, width, height, RGB565 pixels
+
+  // Host -> device
+  MSG_GET_PARAM = 16, // uint8 id (PARAM_ALL for every parameter)
+  MSG_SET_PARAM = 17, // uint8 id, float value
+  // Device -> host, reply to both
+  MSG_PARAM = 18,     // uint8 id, uint8 type, uint8 status, float value, float min, float max, name
+  MSG_CONFIG_COMMAND = 19, // uint8 action (ConfigAction), host -> device
+  MSG_CONFIG_RESULT = 20,  // uint8 action, uint8 status (0 = ok), uint16 bytes stored
+  MSG_GET_SENSOR_STATE = 21, // No payload, host -> device
+  MSG_SENSOR_STATE = 22,     // Per bank: uint8 bank, known bitmap[32], values[256], uint32 skipped, uint32 bus writes,
+                             //   uint32 frame period (micros, 0 = not measured)
+};
+
+// MSG_MASK flags
+constexpr uint8_t MASK_RLE = 0x01;
+// MSG_DELTA_FRAME flags
+constexpr uint8_t DELTA_KEYFRAME = 0x01; // Reference is an all-zero frame
+// MSG_ROI_FRAME flags
+constexpr uint8_t ROI_ON_TARGET = 0x01; // Window follows the tracked target (else frame centre)
+
+// Parameter messages
+constexpr uint8_t PARAM_ALL = 0xFF;
+enum ParamStatus : uint8_t {
+  PARAM_OK = 0,
+  PARAM_UNKNOWN = 1, // No parameter with that id
+  PARAM_RANGE = 2,   // Set rejected, value outside min/max
+  PARAM_MALFORMED = 3,
+};
+constexpr uint32_t paramReplyFixedSize = 15; // Name follows, not terminated
+
+enum ConfigAction : uint8_t {
+  CONFIG_SAVE = 0,  // Current parameters, calibration and classifier table to EEPROM
+  CONFIG_ERASE = 1, // Back to the compiled defaults on the next boot
+};
+
+struct MessageHeader {
+  uint8_t type;
+  uint8_t flags;
+  uint16_t seq;
+  uint32_t length;
+  uint32_t timestamp;
+};
+
+uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t length);
+inline uint32_t crc32(const uint8_t *data, size_t length) {
+  return crc32Update(0, data, length);
+}
+
+inline void put16(uint8_t *out, uint16_t value) {
+  out[0] = value & 0xFF;
+  out[1] = value >> 8;
+}
+
+inline void put32(uint8_t *out, uint32_t value) {
+  put16(out, value & 0xFFFF);
+  put16(out + 2, value >> 16);
+}
+
+inline uint16_t get16(const uint8_t *in) {
+  return in[0] | (in[1] << 8);
+}
+
+inline uint32_t get32(const uint8_t *in) {
+  return get16(in) | ((uint32_t)get16(in + 2) << 16);
+}
+
+// IEEE 754 single on both ends
+inline void putFloat(uint8_t *out, float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  put32(out, bits);
+}
+
+inline float getFloat(const uint8_t *in) {
+  uint32_t bits = get32(in);
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+void encodeHeader(uint8_t *out, const MessageHeader &header);
+bool decodeHeader(const uint8_t *in, MessageHeader &header);
+
+// Builds a complete message into 'out' (headerSize + length + trailerSize bytes)
+size_t encodeMessage(uint8_t *out, const MessageHeader &header, const uint8_t *payload);
+
+// MSG_BLOBS payload, one per processed frame: what the detector, tracker and
+// servo loop decided. Centroids are sent in 1/16 pixel units.
+constexpr int maxRecordBlobs = 16;
+constexpr size_t frameRecordFixedSize = 63;
+constexpr size_t recordBlobSize = 14;
+constexpr size_t frameRecordMaxSize = frameRecordFixedSize + maxRecordBlobs * recordBlobSize;
+
+// FrameRecord flags
+constexpr uint8_t RECORD_TARGET_SET = 0x01;
+constexpr uint8_t RECORD_MOTION_VALID = 0x02;
+
+struct BlobSummary {
+  uint16_t minX, maxX, minY, maxY;
+  float centreX, centreY;
+  uint16_t pixelCount;
+};
+
+struct FrameRecord {
+  uint32_t frame;
+  uint32_t captureStart;                // micros()
+  uint32_t captureMicros;               // Trigger to CAP_DONE
+  uint32_t readoutMicros;               // FIFO readout and classification
+  uint32_t detectMicros;                // Blob labelling
+  uint32_t trackMicros;                 // Association, motion update, publish
+  uint8_t flags;
+  uint8_t blobCount;                    // Detected, may be more than listed
+  int16_t targetX, targetY;             // Tracked centroid (pixels), -1 if none
+  float azimuth, elevation;             // World motion estimate (degrees)
+  float velAzimuth, velElevation;       // deg/s
+  float panCommand, tiltCommand;        // Servo positions (degrees)
+  float panActual, tiltActual;          // Lag-modelled physical positions
+  uint8_t listed;
+  BlobSummary blobs[maxRecordBlobs];
+};
+
+size_t encodeFrameRecord(uint8_t *out, const FrameRecord &record);
+bool decodeFrameRecord(const uint8_t *in, size_t length, FrameRecord &record);
+
+// Mask run-length coding: alternating run lengths of 0s and 1s (starting with 0s,
+// so the first run may be empty), each as a LEB128 varint. Returns the encoded
+// size, or 0 if it would not fit in 'capacity' (send the packed mask instead).
+size_t encodeMaskRle(const uint8_t *mask, uint32_t bits, uint8_t *out, size_t capacity);
+bool decodeMaskRle(const uint8_t *in, size_t length, uint8_t *mask, uint32_t bits);
+
+// RGB565 row compression: XOR against the same row of the previous frame, then
+// run-length code the 16-bit words. Control byte c: c & 0x80 -> (c & 0x7F) + 1
+// unchanged words, else c + 1 literal words follow (little-endian). Runs never
+// cross rows, so a row can be encoded as soon as it has been read.
+constexpr size_t deltaRowMaxSize(int width) {
+  return width * 2 + width / 2 + 1; // Worst case alternates 1 literal, 1 unchanged
+}
+
+// Encodes 'row' and updates 'previous' to what the decoder will hold. Pixels whose
+// channels all differ by at most 'tolerance' count as unchanged (0 = lossless),
+// which keeps sensor noise from defeating the run-length coding without drift.
+// Returns bytes written.
+size_t encodeDeltaRow(const uint16_t *row, uint16_t *previous, int width, int tolerance, uint8_t *out);
+// Applies a whole frame of delta rows to 'frame' (zero it first for a keyframe)
+bool decodeDeltaFrame(const uint8_t *in, size_t length, uint16_t *frame, int width, int height);
+
+// Incremental receiver. Feed it whatever arrived, it copies payloads into the
+// caller's buffer and stops after each complete message.
+struct StreamParser {
+  uint8_t *payload;
+  uint32_t capacity;
+
+  uint8_t header[headerSize];
+  uint32_t received;       // Bytes of the current header/payload/trailer
+  uint8_t state;
+  MessageHeader current;
+  uint32_t crc;
+
+  // Diagnostics
+  uint32_t messages;
+  uint32_t crcErrors;
+  uint32_t skippedBytes;   // Discarded while hunting for a header
+  uint32_t oversized;      // Valid header, payload bigger than 'capacity'
+};
+
+void initParser(StreamParser &parser, uint8_t *payload, uint32_t capacity);
+
+// Returns bytes consumed. 'complete' is set when parser.current and the payload
+// buffer hold a verified message, call again with the remaining bytes.
+size_t parseStream(StreamParser &parser, const uint8_t *data, size_t length, bool &complete);
@@ -0,0 +1,76 @@
+#pragma once
+#include <stdint.h>
+#include <ArduCAM.h>
+#include <memorysaver.h>
+#include <geometry.h>
+#include <camera.h>
+#include <sensorWindow.h>
+
+// Image sensor behind the ArduCAM, one implementation compiled in. The
+// module is picked in memorysaver.h (SENSOR_MOCK for host builds), the
+// vision code only calls what's below. The ArduCAM FIFO/SPI side stays in
+// main.cpp, it's the same for every sensor.
+#if defined(SENSOR_MOCK)
+#define SENSOR_MODEL 0
+#elif defined(OV2640_MINI_2MP_PLUS) || defined(OV2640_MINI_2MP) || defined(OV2640_CAM)
+#define SENSOR_OV2640
+#define SENSOR_MODEL OV2640
+#elif defined(OV5640_MINI_5MP_PLUS) || defined(OV5640_CAM)
+#define SENSOR_OV5640
+#define SENSOR_MODEL OV5640
+#elif defined(OV5642_MINI_5MP_PLUS) || defined(OV5642_MINI_5MP) || defined(OV5642_MINI_5MP_BIT_ROTATION_FIXED) || defined(OV5642_CAM)
+#define SENSOR_OV5642
+#define SENSOR_MODEL OV5642
+#else
+#error Enable an OV2640, OV5640 or OV5642 module in memorysaver.h
+#endif
+
+extern ArduCAM myCAM; // main.cpp
+
+extern const char *const sensorName;
+extern const bool sensorCanWindow; // sensorSetWindow() does something
+extern const bool sensorQueuesWrites; // Deferred writes below wait for a budget
+
+// Exposure and white balance, see the sensor.* parameters in main.cpp
+struct SensorControls {
+  bool autoExposure = true;
+  bool autoGain = true;
+  int exposureLines = 300; // Sensor line periods, manual only
+  int gain = 16;           // 1/16 steps, manual only
+  bool awbLock = false;
+  int clockDivider = 0;    // Sensor clock = input / (divider + 1), where supported
+};
+
+// Chip id over I2C, false if it isn't the sensor this build is for
+bool sensorDetect(uint16_t &id);
+// Reset and load the uncompressed capture tables
+void sensorInit();
+void sensorSetGeometry(Resolution resolution); // Also clears a window
+void sensorSetFormat(CaptureFormat format);
+// Crop to window (frame pixels at the current geometry), disabled = whole frame
+void sensorSetWindow(const SensorWindow &window, FrameSize frame);
+void sensorSetControls(const SensorControls &controls);
+
+// Deferred writes (see startCapture() in main.cpp). Sensors without a write
+// queue apply each group at once and call done() from sensorEndQueue().
+void sensorBeginQueue();
+bool sensorEndQueue(void (*done)());
+int sensorServiceQueue(uint32_t budgetMicros);
+int sensorQueuedGroups();
+
+// Register dump for MSG_SENSOR_STATE, false where the driver keeps no copy
+bool sensorRegister(uint8_t bank, uint8_t reg, uint8_t &value);
+uint32_t sensorWritesSkipped();
+uint32_t sensorBusWrites();
+
+#if defined(SENSOR_MOCK)
+// What the pipeline last asked for, for host tests
+struct MockSensor {
+  Resolution resolution = RES_160x120;
+  CaptureFormat format = CAPTURE_RGB565;
+  SensorWindow window;
+  SensorControls controls;
+  uint32_t geometryChanges = 0, windowChanges = 0, formatChanges = 0, controlChanges = 0;
+};
+extern MockSensor mockSensor;
+#endif
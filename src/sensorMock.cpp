@@ -0,0 +1,75 @@
+#include <sensor.h>
+
+#if defined(SENSOR_MOCK)
+
+// No sensor behind it, settings land in mockSensor at once. The host harness
+// serves the frames itself.
+const char *const sensorName = "mock";
+const bool sensorCanWindow = true;
+const bool sensorQueuesWrites = false;
+
+MockSensor mockSensor;
+
+bool sensorDetect(uint16_t &id) {
+  id = 0;
+  return true;
+}
+
+void sensorInit() {
+  mockSensor = MockSensor();
+}
+
+void sensorSetGeometry(Resolution resolution) {
+  mockSensor.resolution = resolution;
+  mockSensor.window = SensorWindow();
+  mockSensor.geometryChanges++;
+}
+
+void sensorSetFormat(CaptureFormat format) {
+  mockSensor.format = format;
+  mockSensor.formatChanges++;
+}
+
+void sensorSetWindow(const SensorWindow &window, FrameSize frame) {
+  (void)frame;
+  mockSensor.window = window;
+  mockSensor.windowChanges++;
+}
+
+void sensorSetControls(const SensorControls &controls) {
+  mockSensor.controls = controls;
+  mockSensor.controlChanges++;
+}
+
+void sensorBeginQueue() {}
+
+bool sensorEndQueue(void (*done)()) {
+  if (done) done();
+  return true;
+}
+
+int sensorServiceQueue(uint32_t budgetMicros) {
+  (void)budgetMicros;
+  return 0;
+}
+
+int sensorQueuedGroups() {
+  return 0;
+}
+
+bool sensorRegister(uint8_t bank, uint8_t reg, uint8_t &value) {
+  (void)bank;
+  (void)reg;
+  (void)value;
+  return false;
+}
+
+uint32_t sensorWritesSkipped() {
+  return 0;
+}
+
+uint32_t sensorBusWrites() {
+  return 0;
+}
+
+#endif
@@ -0,0 +1,79 @@
+#include <sensor.h>
+
+#if defined(SENSOR_OV2640)
+
+const char *const sensorName = "OV2640";
+const bool sensorCanWindow = true;
+const bool sensorQueuesWrites = true;
+
+// DSP output size per Resolution, all on the CIF timing (see ov2640_modes.h)
+static const uint8_t outputSizes[RES_COUNT] = { OV2640_160x120, OV2640_176x144, OV2640_320x240 };
+
+bool sensorDetect(uint16_t &id) {
+  uint8_t vid, pid;
+  myCAM.wrSensorReg8_8(0xff, 0x01);
+  myCAM.rdSensorReg8_8(OV2640_CHIPID_HIGH, &vid);
+  myCAM.rdSensorReg8_8(OV2640_CHIPID_LOW, &pid);
+  id = (vid << 8) | pid;
+  return vid == 0x26 && (pid == 0x42 || pid == 0x41);
+}
+
+void sensorInit() {
+  myCAM.set_format(BMP);
+  myCAM.InitCAM();
+}
+
+void sensorSetGeometry(Resolution resolution) {
+  myCAM.OV2640_set_JPEG_size(outputSizes[resolution]); // Also restores the full window
+}
+
+void sensorSetFormat(CaptureFormat format) {
+  myCAM.OV2640_set_output_YUV422(format == CAPTURE_YUV422);
+}
+
+void sensorSetWindow(const SensorWindow &window, FrameSize frame) {
+  if (window.enabled) {
+    myCAM.OV2640_set_window(window.sensorX, window.sensorY, window.sensorWidth, window.sensorHeight,
+                            window.width, window.height);
+  } else {
+    myCAM.OV2640_set_window(0, 0, sensorInputWidth, sensorInputHeight, frame.width, frame.height);
+  }
+}
+
+void sensorSetControls(const SensorControls &controls) {
+  myCAM.OV2640_set_clock_divider(controls.clockDivider);
+  myCAM.OV2640_set_auto_exposure(controls.autoExposure, controls.autoGain);
+  if (!controls.autoExposure) myCAM.OV2640_set_exposure(controls.exposureLines);
+  if (!controls.autoGain) myCAM.OV2640_set_gain(controls.gain);
+  myCAM.OV2640_set_AWB_lock(controls.awbLock);
+}
+
+void sensorBeginQueue() {
+  myCAM.OV2640_begin_queue();
+}
+
+bool sensorEndQueue(void (*done)()) {
+  return myCAM.OV2640_end_queue(done);
+}
+
+int sensorServiceQueue(uint32_t budgetMicros) {
+  return myCAM.OV2640_service_queue(budgetMicros);
+}
+
+int sensorQueuedGroups() {
+  return myCAM.OV2640_queued_groups();
+}
+
+bool sensorRegister(uint8_t bank, uint8_t reg, uint8_t &value) {
+  return myCAM.OV2640_shadow_value(bank, reg, &value);
+}
+
+uint32_t sensorWritesSkipped() {
+  return myCAM.shadow_skipped;
+}
+
+uint32_t sensorBusWrites() {
+  return myCAM.shadow_bus_writes;
+}
+
+#endif
@@ -0,0 +1,111 @@
+#include <sensor.h>
+
+#if defined(SENSOR_OV5640) || defined(SENSOR_OV5642)
+
+// OV5640 and OV5642 share the register map used here: 16-bit addresses, ISP
+// scaler output size, AEC/AGC manual bits and the format control. InitCAM()
+// leaves either at QVGA RGB565 with the ISP scaling the sensor readout.
+#if defined(SENSOR_OV5640)
+const char *const sensorName = "OV5640";
+static const uint16_t chipId = 0x5640;
+#else
+const char *const sensorName = "OV5642";
+static const uint16_t chipId = 0x5642;
+#endif
+// sensorWindow.h is laid out for the OV2640 DSP, not implemented here
+const bool sensorCanWindow = false;
+const bool sensorQueuesWrites = false;
+
+static uint32_t busWrites = 0;
+
+static void writeRegister(uint16_t reg, uint8_t value) {
+  myCAM.wrSensorReg16_8(reg, value);
+  busWrites++;
+}
+
+static void writeRegister16(uint16_t reg, uint16_t value) {
+  writeRegister(reg, value >> 8);
+  writeRegister(reg + 1, value & 0xff);
+}
+
+bool sensorDetect(uint16_t &id) {
+  uint8_t vid, pid;
+  myCAM.rdSensorReg16_8(0x300a, &vid);
+  myCAM.rdSensorReg16_8(0x300b, &pid);
+  id = (vid << 8) | pid;
+  return id == chipId;
+}
+
+void sensorInit() {
+  myCAM.set_format(BMP);
+  myCAM.InitCAM();
+}
+
+void sensorSetGeometry(Resolution resolution) {
+  FrameSize size = resolutionSizes[resolution];
+  writeRegister(0x3212, 0x03); // Group hold, the size changes on one frame
+  writeRegister16(0x3808, size.width);
+  writeRegister16(0x380a, size.height);
+  writeRegister(0x3212, 0x13);
+  writeRegister(0x3212, 0xa3);
+}
+
+void sensorSetFormat(CaptureFormat format) {
+  if (format == CAPTURE_YUV422) {
+    writeRegister(0x4300, 0x30); // YUYV
+    writeRegister(0x501f, 0x00); // ISP YUV
+  } else {
+    writeRegister(0x4300, 0x61); // RGB565
+    writeRegister(0x501f, 0x01); // ISP RGB
+  }
+}
+
+void sensorSetWindow(const SensorWindow &window, FrameSize frame) {
+  (void)window;
+  (void)frame;
+}
+
+void sensorSetControls(const SensorControls &controls) {
+  writeRegister(0x3503, (controls.autoExposure ? 0 : 0x01) | (controls.autoGain ? 0 : 0x02));
+  if (!controls.autoExposure) {
+    uint32_t exposure = (uint32_t)constrain(controls.exposureLines, 1, 0xffff) << 4; // 1/16 lines
+    writeRegister(0x3500, exposure >> 16);
+    writeRegister16(0x3501, exposure & 0xffff);
+  }
+  if (!controls.autoGain) writeRegister16(0x350a, constrain(controls.gain, 16, 0x3ff)); // Already 1/16 steps
+  writeRegister(0x3406, controls.awbLock ? 0x01 : 0x00); // Manual AWB, fixed at the 0x3400-0x3405 gains
+}
+
+// No write queue in the driver for these, groups go out as they're written
+void sensorBeginQueue() {}
+
+bool sensorEndQueue(void (*done)()) {
+  if (done) done();
+  return true;
+}
+
+int sensorServiceQueue(uint32_t budgetMicros) {
+  (void)budgetMicros;
+  return 0;
+}
+
+int sensorQueuedGroups() {
+  return 0;
+}
+
+bool sensorRegister(uint8_t bank, uint8_t reg, uint8_t &value) {
+  (void)bank;
+  (void)reg;
+  (void)value;
+  return false;
+}
+
+uint32_t sensorWritesSkipped() {
+  return 0;
+}
+
+uint32_t sensorBusWrites() {
+  return busWrites;
+}
+
+#endif
@@ -0,0 +1,64 @@
+#include "sensorWindow.h"
+#include <cmath>
+#include <algorithm>
+
+// Output sizes and the DSP window size are in units of 4 pixels, the offset in pixels
+constexpr int sizeUnit = 4;
+
+static int gcd(int a, int b) {
+  while (b) {
+    int t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+// Smallest frame pixel step that lands on a whole DSP input pixel
+static int originStep(int frame, int input) {
+  return frame / gcd(frame, input);
+}
+
+// One axis: size fits the registers exactly, origin on the step grid
+static bool placeAxis(int frame, int input, int size, float centre,
+                      uint16_t &origin, uint16_t &sensorOrigin, uint16_t &sensorSize) {
+  if (size <= 0 || size > frame || size % sizeUnit != 0) return false;
+  if ((size * input) % frame != 0 || (size * input / frame) % sizeUnit != 0) return false;
+
+  int step = originStep(frame, input);
+  int maxOrigin = (frame - size) / step * step;
+  int start = (int)std::lround((centre - size * 0.5f) / step) * step;
+  origin = std::clamp(start, 0, maxOrigin);
+  sensorOrigin = origin * input / frame;
+  sensorSize = size * input / frame;
+  return true;
+}
+
+bool placeSensorWindow(SensorWindow &window, FrameSize frame, FrameSize size, float cx, float cy) {
+  window.enabled = placeAxis(frame.width, sensorInputWidth, size.width, cx,
+                             window.x, window.sensorX, window.sensorWidth) &&
+                   placeAxis(frame.height, sensorInputHeight, size.height, cy,
+                             window.y, window.sensorY, window.sensorHeight);
+  window.width = window.enabled ? size.width : 0;
+  window.height = window.enabled ? size.height : 0;
+  return window.enabled;
+}
+
+bool insideWindow(const SensorWindow &window, float x, float y, float margin) {
+  return window.enabled &&
+         x >= window.x + margin && x <= window.x + window.width - 1 - margin &&
+         y >= window.y + margin && y <= window.y + window.height - 1 - margin;
+}
+
+void windowToFrame(const SensorWindow &window, std::vector<Blob> &blobs) {
+  if (!window.enabled) return;
+  for (Blob &blob : blobs) {
+    blob.minX += window.x;
+    blob.maxX += window.x;
+    blob.minY += window.y;
+    blob.maxY += window.y;
+    blob.sumX += window.x * blob.pixelCount;
+    blob.sumY += window.y * blob.pixelCount;
+    windowToFrame(window, blob.centreX, blob.centreY);
+  }
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "geometry.h"
+#include "blobDetection.h"
+
+// Crop done by the OV2640 DSP, so only the area around the target crosses the
+// FIFO. The scale stays that of the full frame: a window pixel is a frame
+// pixel, offset by the window origin. Sensor timing doesn't change.
+
+// DSP input for the CIF sensor timing every Resolution uses
+constexpr uint16_t sensorInputWidth = 800;
+constexpr uint16_t sensorInputHeight = 600;
+
+struct SensorWindow {
+  bool enabled = false;         // False = whole frame
+  uint16_t x = 0, y = 0;        // Origin in frame pixels
+  uint16_t width = 0, height = 0; // Output size
+  // The same region on the DSP input, what the registers take
+  uint16_t sensorX = 0, sensorY = 0;
+  uint16_t sensorWidth = 0, sensorHeight = 0;
+};
+
+// Window of size frame pixels centred on (cx, cy), moved to stay inside the
+// frame and onto the grid the DSP registers can express. False (window
+// disabled) if the size itself can't be expressed.
+bool placeSensorWindow(SensorWindow &window, FrameSize frame, FrameSize size, float cx, float cy);
+
+// At least margin frame pixels from every edge of the window
+bool insideWindow(const SensorWindow &window, float x, float y, float margin);
+
+// Window pixels -> frame pixels
+inline void windowToFrame(const SensorWindow &window, float &x, float &y) {
+  if (!window.enabled) return;
+  x += window.x;
+  y += window.y;
+}
+
+inline void frameToWindow(const SensorWindow &window, float &x, float &y) {
+  if (!window.enabled) return;
+  x -= window.x;
+  y -= window.y;
+}
+
+// Blobs labelled in a window, moved to frame pixels for the tracker
+void windowToFrame(const SensorWindow &window, std::vector<Blob> &blobs);
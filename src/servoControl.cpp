@@ -0,0 +1,77 @@
+#include "servoControl.h"
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+
+void publishTarget(TargetMailbox &box, const TargetSnapshot &snapshot) {
+  uint8_t next = box.published ^ 1;
+  box.slots[next] = snapshot;
+  std::atomic_signal_fence(std::memory_order_release); // Slot written before the flip
+  box.published = next;
+}
+
+TargetSnapshot readTarget(const TargetMailbox &box) {
+  return box.slots[box.published];
+}
+
+void initAxis(AxisController &axis, float kp, float ki, float kd, float kff, float startPos) {
+  axis.kp = kp;
+  axis.ki = ki;
+  axis.kd = kd;
+  axis.kff = kff;
+  axis.deadband = 0.4f;
+  axis.minPos = 0.0f;
+  axis.maxPos = 180.0f;
+  axis.maxRate = 240.0f;
+  axis.iLimit = 30.0f;
+  axis.lag = 0.08f;
+  axis.position = startPos;
+  axis.actual = startPos;
+  resetAxis(axis);
+}
+
+void resetAxis(AxisController &axis) {
+  axis.integral = 0.0f;
+  axis.lastError = 0.0f;
+  axis.hasLastError = false;
+}
+
+float updateAxis(AxisController &axis, float error, float targetVelocity, float dt) {
+  if (dt <= 0.0f) return axis.position;
+
+  // Continuous deadband, no step in output at its edge
+  if (std::fabs(error) <= axis.deadband) error = 0.0f;
+  else error -= std::copysign(axis.deadband, error);
+
+  float derivative = axis.hasLastError ? (error - axis.lastError) / dt : 0.0f;
+  axis.lastError = error;
+  axis.hasLastError = true;
+
+  float rate = axis.kp * error + axis.ki * axis.integral + axis.kd * derivative + axis.kff * targetVelocity;
+
+  // Slew limit, then only integrate when the output is not saturated (anti-windup)
+  float limited = std::max(-axis.maxRate, std::min(rate, axis.maxRate));
+  float next = axis.position + limited * dt;
+  bool atLimit = (next <= axis.minPos && error < 0) || (next >= axis.maxPos && error > 0);
+  if (limited == rate && !atLimit) {
+    axis.integral += error * dt;
+    float maxIntegral = axis.ki > 0.0f ? axis.iLimit / axis.ki : 0.0f;
+    axis.integral = std::max(-maxIntegral, std::min(axis.integral, maxIntegral));
+  }
+
+  axis.position = std::max(axis.minPos, std::min(next, axis.maxPos));
+  axis.actual += (axis.position - axis.actual) * (1.0f - std::exp(-dt / axis.lag));
+  return axis.position;
+}
+
+// Direct move outside the control loop (startup, calibration), assumed settled
+void setAxisPosition(AxisController &axis, float position) {
+  axis.position = std::max(axis.minPos, std::min(position, axis.maxPos));
+  axis.actual = axis.position;
+}
+
+// ~10us per degree, so writeMicroseconds() gives roughly 0.1 degree steps
+int degreesToMicroseconds(float degrees) {
+  float us = servoMinMicros + degrees * (servoMaxMicros - servoMinMicros) / 180.0f;
+  return (int)std::lround(us);
+}
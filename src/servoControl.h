@@ -0,0 +1,49 @@
+#pragma once
+#include <stdint.h>
+#include "blobDetection.h"
+
+// Servo pulse range used by Servo::attach() defaults (0 and 180 degrees)
+constexpr int servoMinMicros = 544;
+constexpr int servoMaxMicros = 2400;
+
+// One servo axis. The PID acts on angular error (degrees) and outputs a rate (deg/s)
+// that is integrated into a float position, so small errors still move the servo.
+struct AxisController {
+  float kp, ki, kd;      // 1/s, 1/s^2, unitless
+  float kff;             // Target angular velocity feedforward, unitless
+  float deadband;        // Error (degrees) ignored around the target, removed smoothly
+  float minPos, maxPos;  // Servo travel (degrees)
+  float maxRate;         // Output slew limit (deg/s)
+  float iLimit;          // Clamp on the integral contribution (deg/s)
+  float lag;             // First-order servo time constant (seconds)
+
+  float position;        // Current command (degrees)
+  float actual;          // Estimated physical position, lags the command by 'lag'
+  float integral;
+  float lastError;
+  bool hasLastError;
+};
+
+// Latest tracker result handed from the vision loop to the servo timer
+struct TargetSnapshot {
+  bool valid = false;
+  uint32_t track = 0;        // Changes on every (re)acquire so the controller can reset
+  TrackerState tracker;      // World-angle motion estimate at the frame timestamp
+};
+
+// Single writer (vision loop), single reader (timer ISR). The writer fills the slot
+// the reader is not using and then flips the index. The ISR can't be preempted by
+// the writer, so it always copies a complete snapshot without locking.
+struct TargetMailbox {
+  TargetSnapshot slots[2];
+  volatile uint8_t published = 0;
+};
+
+void publishTarget(TargetMailbox &box, const TargetSnapshot &snapshot);
+TargetSnapshot readTarget(const TargetMailbox &box);
+
+void initAxis(AxisController &axis, float kp, float ki, float kd, float kff, float startPos);
+void resetAxis(AxisController &axis);
+float updateAxis(AxisController &axis, float error, float targetVelocity, float dt);
+void setAxisPosition(AxisController &axis, float position);
+int degreesToMicroseconds(float degrees);
@@ -0,0 +1,98 @@
+#include <telemetry.h>
+#include <Arduino.h>
+
+DMAMEM uint8_t telemetryBuffer[telemetryBufferSize];
+uint32_t telemetryHead = 0;
+uint32_t telemetryCommitted = 0; // End of the last complete message
+uint32_t telemetryTail = 0;      // Next byte to send
+uint32_t payloadStart = 0;       // Ring position of the open message's payload
+MessageHeader openHeader;
+uint32_t droppedMessages = 0;
+uint16_t messageSeq = 0;
+
+bool telemetryBeginMessage(uint8_t type, uint8_t flags, uint32_t timestamp, uint32_t payloadLength) {
+  uint32_t length = headerSize + payloadLength + trailerSize;
+  if (telemetryHead - telemetryTail + length > telemetryBufferSize) {
+    droppedMessages++;
+    messageSeq++; // Leave a gap so the host can count drops
+    return false;
+  }
+
+  openHeader = { type, flags, messageSeq++, payloadLength, timestamp };
+  uint8_t encoded[headerSize];
+  encodeHeader(encoded, openHeader);
+  telemetryWrite(encoded, headerSize);
+  payloadStart = telemetryHead;
+  return true;
+}
+
+void telemetryWrite(const uint8_t *data, uint32_t length) {
+  for (uint32_t i = 0; i < length; i++) {
+    telemetryWriteByte(data[i]);
+  }
+}
+
+uint32_t telemetryEndMessage() {
+  // Shorter than reserved, rewrite the header in place (not committed yet)
+  uint32_t payloadLength = telemetryHead - payloadStart;
+  if (payloadLength != openHeader.length) {
+    openHeader.length = payloadLength;
+    uint8_t encoded[headerSize];
+    encodeHeader(encoded, openHeader);
+    uint32_t headerStart = payloadStart - headerSize;
+    for (uint32_t i = 0; i < headerSize; i++) {
+      telemetryBuffer[(headerStart + i) & (telemetryBufferSize - 1)] = encoded[i];
+    }
+  }
+
+  // CRC straight from the ring, so per-byte writes stay a single store
+  uint32_t crc = 0;
+  uint32_t remaining = telemetryHead - payloadStart;
+  uint32_t position = payloadStart;
+  while (remaining > 0) {
+    uint32_t offset = position & (telemetryBufferSize - 1);
+    uint32_t chunk = remaining;
+    if (chunk > telemetryBufferSize - offset) chunk = telemetryBufferSize - offset;
+    crc = crc32Update(crc, telemetryBuffer + offset, chunk);
+    position += chunk;
+    remaining -= chunk;
+  }
+
+  uint8_t trailer[trailerSize];
+  put32(trailer, crc);
+  telemetryWrite(trailer, trailerSize);
+  telemetryCommitted = telemetryHead;
+  return payloadLength;
+}
+
+bool telemetrySend(uint8_t type, uint8_t flags, uint32_t timestamp, const uint8_t *payload, uint32_t length) {
+  if (!telemetryBeginMessage(type, flags, timestamp, length)) return false;
+  telemetryWrite(payload, length);
+  telemetryEndMessage();
+  return true;
+}
+
+void serviceTelemetry() {
+  // Nobody listening, discard instead of letting the buffer fill
+  if (!Serial) {
+    telemetryTail = telemetryCommitted;
+    return;
+  }
+
+  uint32_t pending = telemetryCommitted - telemetryTail;
+  int room = Serial.availableForWrite();
+  while (pending > 0 && room > 0) {
+    uint32_t offset = telemetryTail & (telemetryBufferSize - 1);
+    uint32_t chunk = pending;
+    if (chunk > (uint32_t)room) chunk = room;
+    if (chunk > telemetryBufferSize - offset) chunk = telemetryBufferSize - offset; // Wrap
+    Serial.write(telemetryBuffer + offset, chunk);
+    telemetryTail += chunk;
+    pending -= chunk;
+    room -= chunk;
+  }
+}
+
+uint32_t telemetryDropped() {
+  return droppedMessages;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <stdint.h>
+#include <protocol.h>
+
+// Outgoing serial data is staged in a ring buffer and drained to USB from loop
+// slack, so a slow or missing host never stretches the capture loop.
+constexpr uint32_t telemetryBufferSize = 65536; // Power of two, see telemetryFrameBudget
+// Largest preview frame message, header and trailer included, the rest of the
+// ring is left for the mask, blobs and stats queued behind it. A worst case
+// 160x120 compressed frame (48 KB) fits. 176x144 and up don't, even raw, so
+// the preview is decimated instead (initializeFrame) rather than the ring
+// grown: DMAMEM already holds the MaxGeometry frame buffers.
+constexpr uint32_t telemetryFrameBudget = telemetryBufferSize - 16384;
+constexpr int telemetryDecimation = 1;          // Queue every Nth frame
+
+extern uint8_t telemetryBuffer[telemetryBufferSize];
+extern uint32_t telemetryHead; // Next byte written (vision loop)
+
+// Reserve room for a whole framed message and write its header, false if it
+// doesn't fit (message dropped). The payload follows via telemetryWrite(). For
+// variable size payloads pass the maximum, the header is fixed up at the end.
+bool telemetryBeginMessage(uint8_t type, uint8_t flags, uint32_t timestamp, uint32_t payloadLength);
+void telemetryWrite(const uint8_t *data, uint32_t length);
+// Append the payload CRC and make the message visible to serviceTelemetry().
+// Returns the final payload length.
+uint32_t telemetryEndMessage();
+// Whole message in one call
+bool telemetrySend(uint8_t type, uint8_t flags, uint32_t timestamp, const uint8_t *payload, uint32_t length);
+// Send as much as USB accepts right now without blocking
+void serviceTelemetry();
+uint32_t telemetryDropped();
+
+inline void telemetryWriteByte(uint8_t value) {
+  telemetryBuffer[telemetryHead++ & (telemetryBufferSize - 1)] = value;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <stdio.h>
+
+// Host tests are plain programs built with g++ against src/ (the command is at
+// the top of each file). A failed CHECK prints where and the run carries on;
+// the exit status says whether anything failed.
+inline int checkFailures = 0;
+
+#define CHECK(condition)                                                                  \
+  do {                                                                                    \
+    if (!(condition)) {                                                                   \
+      checkFailures++;                                                                    \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);      \
+    }                                                                                     \
+  } while (0)
+
+inline int testResult(const char *name) {
+  if (checkFailures) fprintf(stderr, "%s: %d checks failed\n", name, checkFailures);
+  else printf("%s: ok\n", name);
+  return checkFailures ? 1 : 0;
+}
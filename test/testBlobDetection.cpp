@@ -0,0 +1,85 @@
+// Blob size threshold from src/blobDetection.h, in the labeller and target selection.
+//
+//   g++ -O2 -std=gnu++17 -Isrc -Itest test/testBlobDetection.cpp src/blobDetection.cpp -o testBlobDetection && ./testBlobDetection
+#include <string.h>
+#include "blobDetection.h"
+#include "check.h"
+
+using Window176x144 = WindowGeometry<Frame176x144>;
+
+static uint8_t mask[MaxGeometry::maskBytes];
+
+static void setPixel(int x, int y, int width) {
+  int idx = y * width + x;
+  mask[idx >> 3] |= 1 << (idx & 7);
+}
+
+// A horizontal run of pixelCount at (x, y)
+template <typename Geometry>
+static void addRun(int x, int y, int pixelCount) {
+  for (int i = 0; i < pixelCount; i++) setPixel(x + i, y, Geometry::width);
+}
+
+static void testReferenceThreshold() {
+  blobMinPixels = 4;
+  CHECK(scaledMinPixels<ReferenceGeometry>() == 4);
+  std::vector<Blob> blobs;
+  memset(mask, 0, sizeof(mask));
+  addRun<ReferenceGeometry>(10, 10, 4);
+  addRun<ReferenceGeometry>(10, 20, 5);
+  detectBlobs<ReferenceGeometry>(mask, blobs);
+  CHECK(blobs.size() == 1 && blobs[0].pixelCount == 5);
+}
+
+// Window pixels are frame pixels: the threshold is the whole frame's, not
+// scaled down by the window's smaller area
+static void testWindowKeepsFrameThreshold() {
+  blobMinPixels = 4;
+  int minPixels = scaledMinPixels<Frame176x144>();
+  CHECK(minPixels == 5);
+  CHECK(scaledMinPixels<Window176x144>() < minPixels);
+
+  std::vector<Blob> blobs;
+  memset(mask, 0, sizeof(mask));
+  addRun<Window176x144>(4, 4, minPixels);      // Just under
+  addRun<Window176x144>(4, 10, 2);             // Noise
+  addRun<Window176x144>(4, 20, minPixels + 1); // Just over
+  detectBlobs<Window176x144, Frame176x144>(mask, blobs);
+  CHECK(blobs.size() == 1 && blobs[0].pixelCount == minPixels + 1);
+  CHECK(blobs.size() == 1 && blobs[0].minY == 20);
+
+  // The same mask at the whole frame
+  memset(mask, 0, sizeof(mask));
+  addRun<Frame176x144>(4, 4, minPixels);
+  addRun<Frame176x144>(4, 20, minPixels + 1);
+  detectBlobs<Frame176x144>(mask, blobs);
+  CHECK(blobs.size() == 1 && blobs[0].pixelCount == minPixels + 1);
+}
+
+static Blob blobOfSize(int pixelCount) {
+  return { 1, 10, 9 + pixelCount, 10, 10, 10 * pixelCount, 10 * pixelCount, pixelCount, 10, 10 };
+}
+
+// The target takes the labeller's threshold, blobMinPixels moves both
+static void testTargetThreshold() {
+  TrackerState state;
+  bool targetSet = true;
+  for (int minPixels : { 4, 10 }) {
+    blobMinPixels = minPixels;
+    std::vector<Blob> blobs = { blobOfSize(scaledMinPixels<Frame320x240>()) };
+    setCurrentTarget<Frame320x240>(blobs, targetSet, state);
+    CHECK(!targetSet);
+    blobs.push_back(blobOfSize(scaledMinPixels<Frame320x240>() + 1));
+    setCurrentTarget<Frame320x240>(blobs, targetSet, state);
+    CHECK(targetSet);
+  }
+  CHECK(scaledMinPixels<Frame320x240>() == 40);
+  blobMinPixels = 4;
+}
+
+int main() {
+  testReferenceThreshold();
+  testWindowKeepsFrameThreshold();
+  testTargetThreshold();
+  return testResult("testBlobDetection");
+}
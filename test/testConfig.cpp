@@ -0,0 +1,138 @@
+// Saved configuration blob from src/config.cpp.
+//
+//   g++ -O2 -std=gnu++17 -Isrc -Itest test/testConfig.cpp src/config.cpp src/params.cpp src/protocol.cpp -o testConfig && ./testConfig
+#include <vector>
+#include "config.h"
+#include "protocol.h"
+#include "check.h"
+
+static int threshold = 40;
+static float gain = 2.5f;
+static uint8_t mode = 1;
+static int changes = 0;
+static void changed() { changes++; }
+
+static const Parameter table[] = {
+  { 1, "threshold", PARAM_INT, &threshold, 0, 255, changed },
+  { 20, "gain", PARAM_FLOAT, &gain, 0, 10, changed },
+  { 30, "mode", PARAM_UINT8, &mode, 0, 3, changed },
+};
+constexpr int tableCount = sizeof(table) / sizeof(table[0]);
+
+static Calibration calibrationOf() {
+  Calibration cal;
+  cal.valid = true;
+  cal.pixelsPerDegreeX = 2.71f;
+  cal.pixelsPerDegreeY = 2.64f;
+  cal.panSign = -1;
+  cal.tiltSign = 1;
+  cal.lagH = 0.083f;
+  cal.lagV = 0.091f;
+  return cal;
+}
+
+// Classifier-like table: a few long runs of set bits
+static std::vector<uint8_t> classifierOf() {
+  std::vector<uint8_t> classifier(65536 / 8, 0);
+  for (uint32_t i = 0; i < 65536; i++) {
+    if ((i >> 11) >= 24 && ((i >> 5) & 63) < 20) classifier[i >> 3] |= 1 << (i & 7);
+  }
+  return classifier;
+}
+
+static std::vector<uint8_t> encoded(const uint8_t *classifier, size_t capacity = 4096) {
+  std::vector<uint8_t> out(capacity);
+  size_t length = encodeConfig(table, tableCount, calibrationOf(), classifier, out.data(), out.size());
+  out.resize(length);
+  return out;
+}
+
+static void testRoundTrip() {
+  std::vector<uint8_t> classifier = classifierOf();
+  std::vector<uint8_t> blob = encoded(classifier.data());
+  CHECK(!blob.empty());
+
+  ConfigData config;
+  CHECK(decodeConfig(blob.data(), blob.size(), config));
+  CHECK(config.paramCount == tableCount);
+
+  threshold = 0, gain = 0, mode = 0, changes = 0;
+  CHECK(applyConfigParameters(config, table, tableCount) == tableCount);
+  CHECK(threshold == 40 && gain == 2.5f && mode == 1);
+  CHECK(changes == 0); // Restored without the hooks
+
+  Calibration cal = calibrationOf();
+  CHECK(config.calibration.valid);
+  CHECK(config.calibration.pixelsPerDegreeX == cal.pixelsPerDegreeX && config.calibration.lagV == cal.lagV);
+  CHECK(config.calibration.panSign == -1 && config.calibration.tiltSign == 1);
+
+  std::vector<uint8_t> loaded(65536 / 8, 0xAA);
+  CHECK(loadConfigClassifier(config, loaded.data()));
+  CHECK(loaded == classifier);
+}
+
+static void testWithoutClassifier() {
+  std::vector<uint8_t> blob = encoded(nullptr);
+  ConfigData config;
+  CHECK(decodeConfig(blob.data(), blob.size(), config));
+  CHECK(config.classifierRle == nullptr);
+  std::vector<uint8_t> loaded(65536 / 8);
+  CHECK(!loadConfigClassifier(config, loaded.data()));
+
+  // No room for the table: left out, the rest still saved
+  std::vector<uint8_t> classifier = classifierOf();
+  blob = encoded(classifier.data(), configHeaderSize + 1 + tableCount * 5 + configCalibrationSize + 2 + 4);
+  CHECK(!blob.empty());
+  CHECK(decodeConfig(blob.data(), blob.size(), config) && config.classifierRle == nullptr);
+
+  // No room for the parameters
+  CHECK(encoded(nullptr, configHeaderSize + 8).empty());
+}
+
+// Any single damaged byte, any truncation, blank EEPROM: rejected, defaults stay
+static void testCorrupt() {
+  std::vector<uint8_t> classifier = classifierOf();
+  std::vector<uint8_t> blob = encoded(classifier.data());
+  ConfigData config;
+
+  for (size_t i = 0; i < blob.size(); i++) {
+    for (uint8_t flip : { 0x01, 0x80 }) {
+      std::vector<uint8_t> damaged = blob;
+      damaged[i] ^= flip;
+      CHECK(!decodeConfig(damaged.data(), damaged.size(), config));
+    }
+  }
+  for (size_t cut = 0; cut < blob.size(); cut++) CHECK(!decodeConfig(blob.data(), cut, config));
+
+  std::vector<uint8_t> blank(1024, 0xFF);
+  CHECK(!decodeConfig(blank.data(), blank.size(), config));
+}
+
+// A blob from another firmware: unknown ids are skipped, out-of-range values
+// rejected, parameters it doesn't mention keep their defaults
+static void testOtherFirmware() {
+  int oldThreshold = 12, dropped = 0;
+  float oldGain = 50; // Outside this firmware's range
+  const Parameter other[] = {
+    { 1, "threshold", PARAM_INT, &oldThreshold, 0, 255, nullptr },
+    { 20, "gain", PARAM_FLOAT, &oldGain, 0, 100, nullptr },
+    { 99, "dropped", PARAM_INT, &dropped, 0, 10, nullptr },
+  };
+  std::vector<uint8_t> blob(512);
+  blob.resize(encodeConfig(other, 3, Calibration(), nullptr, blob.data(), blob.size()));
+  ConfigData config;
+  CHECK(decodeConfig(blob.data(), blob.size(), config));
+  CHECK(!config.calibration.valid);
+
+  threshold = 40, gain = 2.5f, mode = 2;
+  CHECK(applyConfigParameters(config, table, tableCount) == 1);
+  CHECK(threshold == 12 && gain == 2.5f && mode == 2);
+}
+
+int main() {
+  testRoundTrip();
+  testWithoutClassifier();
+  testCorrupt();
+  testOtherFirmware();
+  return testResult("testConfig");
+}
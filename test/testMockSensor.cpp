@@ -0,0 +1,139 @@
+// loop() from acquire to track and back, against the mock sensor (src/sensorMock.cpp)
+// with frames rendered for whatever it was last asked for.
+//
+//   g++ -O2 -std=gnu++17 -Ihost/shim -Isrc -Ihost -Itest test/testMockSensor.cpp src/*.cpp
+//       host/shim/shim.cpp host/shim/replayCamera.cpp -o testMockSensor && ./testMockSensor
+#include <string.h>
+#include "params.h"
+#include "sensor.h"
+#include "replayHardware.h"
+#include "check.h"
+
+void setup();
+void loop();
+extern bool targetSet;
+extern Resolution activeResolution;
+extern SensorWindow activeWindow;
+extern CaptureFormat activeFormat;
+
+// Red disc over grey, placed as a fraction of the full frame
+constexpr float discX = 0.62f, discY = 0.45f, discRadius = 0.06f;
+static bool discShown = false;
+static uint32_t exposure = 0;
+
+static bool inDisc(float x, float y) {
+  float dx = x - discX, dy = (y - discY) * 0.75f;
+  return discShown && dx * dx + dy * dy < discRadius * discRadius;
+}
+
+static uint8_t clampByte(int value) {
+  return value < 0 ? 0 : value > 255 ? 255 : value;
+}
+
+// The FIFO as the mock sensor's geometry, window and format would fill it
+static bool nextFrame(uint16_t *pixels, uint32_t &timestamp) {
+  FrameSize frame = resolutionSizes[mockSensor.resolution];
+  const SensorWindow &window = mockSensor.window;
+  int width = window.enabled ? window.width : frame.width;
+  int height = window.enabled ? window.height : frame.height;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      float fx = (window.x + x + 0.5f) / frame.width, fy = (window.y + y + 0.5f) / frame.height;
+      bool red = inDisc(fx, fy);
+      uint8_t r = red ? 200 : 110, g = red ? 30 : 120, b = red ? 30 : 115;
+      uint16_t &word = pixels[y * width + x];
+      if (mockSensor.format == CAPTURE_YUV422) {
+        // Y U Y V: every word is a Y and, alternately, the pair's U or V
+        int luma = (77 * r + 150 * g + 29 * b) >> 8;
+        int chroma = x & 1 ? ((128 * r - 107 * g - 21 * b) >> 8) + 128 : ((-43 * r - 85 * g + 128 * b) >> 8) + 128;
+        word = clampByte(luma) << 8 | clampByte(chroma);
+      } else {
+        word = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+      }
+    }
+  }
+  exposure += 40000;
+  timestamp = exposure;
+  return true;
+}
+
+static bool setNamedParameter(const char *name, float value) {
+  for (int i = 0; i < parameterCount; i++) {
+    if (strcmp(parameters[i].name, name) == 0) return setParameter(parameters[i], value);
+  }
+  return false;
+}
+
+static void step(int frames = 1) {
+  for (int i = 0; i < frames; i++) {
+    loop();
+    takeSerialOutput();
+  }
+}
+
+// loop() calls until targetSet turns to wanted, -1 if it doesn't within limit
+static int loopsUntilTarget(bool wanted, int limit) {
+  for (int frame = 1; frame <= limit; frame++) {
+    step();
+    if (targetSet == wanted) return frame;
+  }
+  return -1;
+}
+
+int main() {
+  setFrameSource(nextFrame);
+  setup();
+  takeSerialOutput();
+
+  // Setup loads the acquire geometry and the controls, nothing else
+  CHECK(mockSensor.geometryChanges == 1 && mockSensor.controlChanges == 1);
+  CHECK(mockSensor.windowChanges == 0 && mockSensor.formatChanges == 0);
+  CHECK(mockSensor.resolution == RES_160x120 && mockSensor.format == CAPTURE_RGB565);
+
+  CHECK(setNamedParameter("trackResolution", RES_176x144));
+  CHECK(setNamedParameter("sensorWindow", 1));
+
+  // Nothing in view: the sensor is left alone
+  step(5);
+  CHECK(!targetSet);
+  CHECK(mockSensor.geometryChanges == 1 && mockSensor.windowChanges == 0);
+
+  // Acquire, then the next frame switches to the track geometry and crops around the target
+  discShown = true;
+  CHECK(loopsUntilTarget(true, 3) == 1);
+  CHECK(mockSensor.geometryChanges == 1);
+  step();
+  CHECK(targetSet);
+  CHECK(mockSensor.geometryChanges == 2 && mockSensor.controlChanges == 2); // Controls follow a geometry load
+  CHECK(mockSensor.resolution == RES_176x144 && activeResolution == RES_176x144);
+  CHECK(mockSensor.windowChanges == 1);
+  CHECK(mockSensor.window.enabled && mockSensor.window.width == 88 && mockSensor.window.height == 72);
+  CHECK(insideWindow(mockSensor.window, discX * 176, discY * 144, 0));
+  CHECK(activeWindow.enabled && activeWindow.x == mockSensor.window.x && activeWindow.y == mockSensor.window.y);
+
+  // Target held still: the window stays put
+  step(10);
+  CHECK(targetSet);
+  CHECK(mockSensor.geometryChanges == 2 && mockSensor.windowChanges == 1 && mockSensor.formatChanges == 0);
+
+  // Format switch while tracking, once
+  CHECK(setNamedParameter("captureFormat", CAPTURE_YUV422));
+  step();
+  CHECK(mockSensor.formatChanges == 1 && mockSensor.format == CAPTURE_YUV422 && activeFormat == CAPTURE_YUV422);
+  step(5);
+  CHECK(targetSet);
+  CHECK(mockSensor.formatChanges == 1 && mockSensor.windowChanges == 1);
+
+  // Target gone: the miss is followed by a capture to re-acquire from, which
+  // finds nothing either. Back to the whole acquire frame.
+  discShown = false;
+  CHECK(loopsUntilTarget(false, 20) == 1);
+  step();
+  CHECK(mockSensor.geometryChanges == 3 && mockSensor.controlChanges == 3);
+  CHECK(mockSensor.resolution == RES_160x120 && activeResolution == RES_160x120);
+  CHECK(!mockSensor.window.enabled && !activeWindow.enabled);
+  CHECK(mockSensor.windowChanges == 1); // The geometry load already cleared the window
+  CHECK(mockSensor.format == CAPTURE_YUV422 && mockSensor.formatChanges == 1);
+
+  return testResult("testMockSensor");
+}
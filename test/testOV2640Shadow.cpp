@@ -0,0 +1,119 @@
+// OV2640 register shadow in lib/ArduCAM, over a bus that records every write.
+//
+//   g++ -O2 -std=gnu++17 -DTEENSYDUINO -Ilib/ArduCAM -Ihost/shim -Itest test/testOV2640Shadow.cpp
+//       lib/ArduCAM/ArduCAM.cpp host/shim/shim.cpp -o testOV2640Shadow && ./testOV2640Shadow
+#include <vector>
+#include "ArduCAM.h"
+#include "check.h"
+
+struct BusWrite {
+  int bank;
+  uint8_t reg, value;
+};
+
+static std::vector<BusWrite> busWrites;
+static int busBank = -1;
+
+static void fakeSelect(bool) {}
+static uint8_t fakeTransfer(uint8_t) { return 0; }
+static void fakeTransfers(uint8_t *, uint32_t) {}
+
+static uint8_t fakeI2cWrite(uint8_t, const uint8_t *data, uint8_t length) {
+  if (length < 2) return 0;
+  if (data[0] == 0xff) busBank = data[1] & 0x01;
+  else busWrites.push_back({ busBank, data[0], data[1] });
+  return 0;
+}
+
+// Every read is the chip id, enough for the wait after reset
+static uint8_t fakeI2cRead(uint8_t, uint8_t *data, uint8_t length) {
+  for (uint8_t i = 0; i < length; i++) data[i] = 0x26;
+  return length;
+}
+
+static const ArduCAM_transport fakeBus = { fakeSelect, fakeTransfer, fakeTransfers, fakeI2cWrite, fakeI2cRead };
+
+static bool dataPort(uint8_t reg) {
+  return reg == 0x7d || reg == 0x91 || reg == 0x93 || reg == 0x97 || reg == 0xa7;
+}
+
+// Bank 0 data port writes, in order, as a table would send them
+static std::vector<BusWrite> dataPortWrites(const std::vector<BusWrite> &writes) {
+  std::vector<BusWrite> out;
+  for (const BusWrite &w : writes) {
+    if (w.bank == 0 && dataPort(w.reg)) out.push_back(w);
+  }
+  return out;
+}
+
+static void tableWrites(std::vector<BusWrite> &out, int &bank, const OV2640_reg *table, int count) {
+  for (int i = 0; i < count; i++) {
+    if (table[i].reg == 0xff) bank = table[i].val & 0x01;
+    else out.push_back({ bank, table[i].reg, table[i].val });
+  }
+}
+
+static bool sameWrites(const std::vector<BusWrite> &a, const std::vector<BusWrite> &b) {
+  if (a.size() != b.size()) return false;
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].bank != b[i].bank || a[i].reg != b[i].reg || a[i].value != b[i].value) return false;
+  }
+  return true;
+}
+
+// Address then data, with the same value repeated: each one lands at the next offset
+static const OV2640_reg repeatedData[] = {
+  { 0xff, 0x00 },
+  { 0x90, 0x00 }, { 0x91, 0x20 }, { 0x91, 0x20 }, { 0x91, 0x20 },
+  { 0x92, 0x00 }, { 0x93, 0x00 }, { 0x93, 0x00 }, { 0x93, 0x00 },
+  { 0x96, 0x00 }, { 0x97, 0x00 }, { 0x97, 0x00 },
+  { 0xa6, 0x00 }, { 0xa7, 0x18 }, { 0xa7, 0x18 },
+  { 0x7c, 0x00 }, { 0x7d, 0x04 }, { 0x7d, 0x04 },
+};
+constexpr int repeatedCount = sizeof(repeatedData) / sizeof(repeatedData[0]);
+
+static void testRepeatedDataPortWrites(ArduCAM &cam) {
+  cam.OV2640_shadow_reset();
+  busWrites.clear();
+  cam.wrSensorRegs8_8(repeatedData, repeatedCount);
+  CHECK((int)busWrites.size() == repeatedCount - 1);
+  CHECK(cam.shadow_skipped == 0);
+
+  // Loaded again: the address resets and every data write goes out again
+  busWrites.clear();
+  cam.wrSensorRegs8_8(repeatedData, repeatedCount);
+  CHECK((int)busWrites.size() == repeatedCount - 1);
+  CHECK(cam.shadow_skipped == 1); // The bank select
+
+  // An ordinary register still isn't rewritten with the value it has
+  busWrites.clear();
+  cam.wrSensorReg8_8(0xc0, 0x64);
+  cam.wrSensorReg8_8(0xc0, 0x64);
+  CHECK(busWrites.size() == 1);
+  CHECK(cam.shadow_skipped == 2);
+}
+
+// The boot tables' gamma, matrix and lens loads reach the bus whole and in order
+static void testBootTables(ArduCAM &cam) {
+  cam.OV2640_shadow_reset();
+  busWrites.clear();
+  busBank = -1;
+  cam.InitCAM();
+
+  std::vector<BusWrite> expected;
+  int bank = 1;
+  tableWrites(expected, bank, OV2640_TABLE(OV2640_QVGA_SENSOR));
+  tableWrites(expected, bank, OV2640_TABLE(OV2640_INIT_DSP));
+  tableWrites(expected, bank, OV2640_TABLE(OV2640_QVGA_OUTPUT));
+  std::vector<BusWrite> sent = dataPortWrites(busWrites);
+  CHECK(dataPortWrites(expected).size() > 40);
+  CHECK(sameWrites(sent, dataPortWrites(expected)));
+}
+
+int main() {
+  ArduCAM cam(OV2640, 10);
+  cam.set_transport(&fakeBus);
+  testRepeatedDataPortWrites(cam);
+  testBootTables(cam);
+  return testResult("testOV2640Shadow");
+}
@@ -0,0 +1,333 @@
+// Stream framing and payload codecs from src/protocol.cpp.
+//
+//   g++ -O2 -std=gnu++17 -Isrc -Itest test/testProtocol.cpp src/protocol.cpp -o testProtocol && ./testProtocol
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+#include "protocol.h"
+#include "check.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+static Bytes message(uint8_t type, uint16_t seq, const Bytes &payload, uint32_t timestamp = 1000) {
+  MessageHeader header = { type, 0, seq, (uint32_t)payload.size(), timestamp };
+  Bytes out(headerSize + payload.size() + trailerSize);
+  encodeMessage(out.data(), header, payload.data());
+  return out;
+}
+
+static Bytes payloadOf(int length, uint8_t seed) {
+  Bytes payload(length);
+  for (int i = 0; i < length; i++) payload[i] = (uint8_t)(seed + i * 7);
+  return payload;
+}
+
+static void append(Bytes &to, const Bytes &from) {
+  to.insert(to.end(), from.begin(), from.end());
+}
+
+// Every complete message in 'stream', fed 'chunk' bytes at a time
+struct Parsed {
+  std::vector<MessageHeader> headers;
+  std::vector<Bytes> payloads;
+};
+
+static Parsed parseAll(StreamParser &parser, uint8_t *buffer, const Bytes &stream, size_t chunk) {
+  Parsed parsed;
+  for (size_t start = 0; start < stream.size(); start += chunk) {
+    size_t end = std::min(stream.size(), start + chunk), offset = start;
+    while (offset < end) {
+      bool complete;
+      offset += parseStream(parser, stream.data() + offset, end - offset, complete);
+      if (!complete) continue;
+      parsed.headers.push_back(parser.current);
+      parsed.payloads.push_back(Bytes(buffer, buffer + parser.current.length));
+    }
+  }
+  return parsed;
+}
+
+static void testCrc() {
+  const uint8_t check[] = "123456789";
+  CHECK(crc32(check, 9) == 0xCBF43926); // Standard check value, matches zlib/binascii
+  CHECK(crc32Update(crc32(check, 4), check + 4, 5) == crc32(check, 9));
+}
+
+static void testRoundTrip() {
+  Bytes stream;
+  for (int i = 0; i < 5; i++) append(stream, message(MSG_BLOBS + i % 2, i, payloadOf(i * 50, i), 1000 + i));
+  append(stream, message(MSG_GET_SENSOR_STATE, 5, Bytes())); // Empty payload
+
+  for (size_t chunk : { (size_t)1, (size_t)7, stream.size() }) {
+    uint8_t buffer[512];
+    StreamParser parser;
+    initParser(parser, buffer, sizeof(buffer));
+    Parsed parsed = parseAll(parser, buffer, stream, chunk);
+    CHECK(parsed.headers.size() == 6);
+    for (size_t i = 0; i < parsed.headers.size() && i < 5; i++) {
+      CHECK(parsed.headers[i].seq == i);
+      CHECK(parsed.headers[i].type == MSG_BLOBS + i % 2);
+      CHECK(parsed.headers[i].timestamp == 1000 + i);
+      CHECK(parsed.payloads[i] == payloadOf(i * 50, i));
+    }
+    CHECK(parser.crcErrors == 0 && parser.skippedBytes == 0);
+  }
+}
+
+// Junk, false magic and a damaged header between messages: the parser finds
+// the next real header and loses nothing after it
+static void testResync() {
+  Bytes stream = { 0x00, 0xA5, 0x13, 0xA5, 0x5A, 0x01 }; // Junk with a half and a full magic
+  append(stream, message(MSG_BLOBS, 1, payloadOf(20, 1)));
+  Bytes damaged = message(MSG_BLOBS, 2, payloadOf(20, 2));
+  damaged[7] ^= 0x40; // Length, caught by the header CRC
+  append(stream, damaged);
+  append(stream, message(MSG_BLOBS, 3, payloadOf(20, 3)));
+  // A payload that looks like a header start
+  Bytes fake = { 0xA5, 0x5A, 0xA5, 0x5A, 0x00, 0xA5 };
+  append(stream, message(MSG_BLOBS, 4, fake));
+
+  for (size_t chunk : { (size_t)1, (size_t)5, stream.size() }) {
+    uint8_t buffer[256];
+    StreamParser parser;
+    initParser(parser, buffer, sizeof(buffer));
+    Parsed parsed = parseAll(parser, buffer, stream, chunk);
+    CHECK(parsed.headers.size() == 3);
+    if (parsed.headers.size() != 3) continue;
+    CHECK(parsed.headers[0].seq == 1 && parsed.payloads[0] == payloadOf(20, 1));
+    CHECK(parsed.headers[1].seq == 3 && parsed.payloads[1] == payloadOf(20, 3));
+    CHECK(parsed.headers[2].seq == 4 && parsed.payloads[2] == fake);
+    CHECK(parser.skippedBytes > 0);
+  }
+}
+
+// A damaged payload is dropped on its CRC, the following message survives
+static void testPayloadCorruption() {
+  Bytes stream = message(MSG_BLOBS, 1, payloadOf(40, 1));
+  stream[headerSize + 10] ^= 0x01;
+  append(stream, message(MSG_BLOBS, 2, payloadOf(40, 2)));
+  Bytes trailer = message(MSG_BLOBS, 3, payloadOf(40, 3));
+  trailer.back() ^= 0x80; // Damaged trailer
+  append(stream, trailer);
+  append(stream, message(MSG_BLOBS, 4, payloadOf(40, 4)));
+
+  uint8_t buffer[256];
+  StreamParser parser;
+  initParser(parser, buffer, sizeof(buffer));
+  Parsed parsed = parseAll(parser, buffer, stream, 3);
+  CHECK(parsed.headers.size() == 2);
+  CHECK(parser.crcErrors == 2);
+  if (parsed.headers.size() == 2) {
+    CHECK(parsed.headers[0].seq == 2 && parsed.payloads[0] == payloadOf(40, 2));
+    CHECK(parsed.headers[1].seq == 4);
+  }
+}
+
+// Cut off anywhere, nothing is reported; the rest completes it
+static void testTruncated() {
+  Bytes whole = message(MSG_BLOBS, 9, payloadOf(30, 9));
+  for (size_t cut = 0; cut < whole.size(); cut++) {
+    uint8_t buffer[64];
+    StreamParser parser;
+    initParser(parser, buffer, sizeof(buffer));
+    bool complete;
+    size_t used = parseStream(parser, whole.data(), cut, complete);
+    CHECK(used == cut && !complete);
+    used = parseStream(parser, whole.data() + cut, whole.size() - cut, complete);
+    CHECK(complete && parser.current.seq == 9 && Bytes(buffer, buffer + 30) == payloadOf(30, 9));
+  }
+}
+
+// Payload bigger than the receiver's buffer: skipped whole, counted, the next one parses
+static void testOversized() {
+  Bytes stream = message(MSG_RAW_FRAME, 1, payloadOf(100, 1));
+  append(stream, message(MSG_BLOBS, 2, payloadOf(10, 2)));
+  uint8_t buffer[32];
+  StreamParser parser;
+  initParser(parser, buffer, sizeof(buffer));
+  Parsed parsed = parseAll(parser, buffer, stream, stream.size());
+  CHECK(parser.oversized == 1);
+  CHECK(parsed.headers.size() == 1 && parsed.headers[0].seq == 2);
+
+  // A header claiming more than maxPayloadSize is treated as corrupt
+  MessageHeader header = { MSG_RAW_FRAME, 0, 0, maxPayloadSize + 1, 0 };
+  uint8_t raw[headerSize];
+  encodeHeader(raw, header);
+  MessageHeader decoded;
+  CHECK(!decodeHeader(raw, decoded));
+}
+
+// Deterministic pseudo-random mask with roughly 'percent' set bits, in blobs
+static Bytes maskOf(uint32_t bits, int percent, uint32_t seed) {
+  Bytes mask((bits + 7) / 8, 0);
+  uint32_t state = seed;
+  bool on = false;
+  for (uint32_t i = 0; i < bits; i++) {
+    state = state * 1664525u + 1013904223u;
+    if ((state >> 24) % 16 == 0) on = (int)((state >> 8) % 100) < percent; // Runs of ~16 bits
+    if (on) mask[i >> 3] |= 1 << (i & 7);
+  }
+  return mask;
+}
+
+static void testMaskRoundTrip() {
+  for (uint32_t bits : { 1u, 7u, 8u, 100u, 160u * 120u, 320u * 240u }) {
+    for (int percent : { 0, 5, 50, 100 }) {
+      Bytes mask = maskOf(bits, percent, bits + percent);
+      if (percent == 100) std::fill(mask.begin(), mask.end(), 0xFF); // First run empty
+      Bytes encoded(bits * 2 + 8);
+      size_t length = encodeMaskRle(mask.data(), bits, encoded.data(), encoded.size());
+      CHECK(length > 0);
+      Bytes decoded(mask.size(), 0xEE);
+      CHECK(decodeMaskRle(encoded.data(), length, decoded.data(), bits));
+      for (uint32_t i = 0; i < bits; i++) {
+        if (((mask[i >> 3] ^ decoded[i >> 3]) >> (i & 7)) & 1) {
+          CHECK(!"mask bit differs");
+          break;
+        }
+      }
+    }
+  }
+
+  // One run over 2^14 bits takes a 3-byte varint
+  const uint32_t bits = 320 * 240;
+  Bytes zeros(bits / 8, 0), encoded(16);
+  CHECK(encodeMaskRle(zeros.data(), bits, encoded.data(), encoded.size()) == 3);
+}
+
+// Alternating bits can't be coded in less than the packed size, the encoder
+// says so rather than overrunning
+static void testMaskCapacity() {
+  const uint32_t bits = 160 * 120;
+  Bytes mask(bits / 8, 0x55);
+  Bytes encoded(bits / 8 + 16, 0xCC);
+  CHECK(encodeMaskRle(mask.data(), bits, encoded.data(), bits / 8) == 0);
+  CHECK(encoded[bits / 8] == 0xCC);
+}
+
+static void testMaskCorrupt() {
+  const uint32_t bits = 160 * 120;
+  Bytes mask = maskOf(bits, 20, 7), decoded(mask.size());
+  Bytes encoded(bits);
+  size_t length = encodeMaskRle(mask.data(), bits, encoded.data(), encoded.size());
+
+  // Every prefix, including one ending inside a varint, is short of the mask
+  for (size_t cut = 0; cut < length; cut++) CHECK(!decodeMaskRle(encoded.data(), cut, decoded.data(), bits));
+
+  // An extra run goes past the end
+  Bytes longer(encoded.begin(), encoded.begin() + length);
+  longer.push_back(1);
+  CHECK(!decodeMaskRle(longer.data(), longer.size(), decoded.data(), bits));
+
+  // A single run of 19200: exactly the mask, one bit too many for a smaller one
+  const uint8_t run[] = { 0x80, 0x96, 0x01 };
+  CHECK(decodeMaskRle(run, sizeof(run), decoded.data(), bits));
+  CHECK(!decodeMaskRle(run, sizeof(run), decoded.data(), bits - 1));
+
+  // Varint longer than 32 bits
+  const uint8_t endless[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01 };
+  CHECK(!decodeMaskRle(endless, sizeof(endless), decoded.data(), bits));
+}
+
+// Still background with a moving square and one step of sensor noise, like a camera frame
+static std::vector<uint16_t> frameOf(int width, int height, int t) {
+  std::vector<uint16_t> frame(width * height);
+  uint32_t state = t * 7919 + 1;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      state = state * 1664525u + 1013904223u;
+      int noise = (state >> 30) & 1;
+      bool square = x >= t * 10 && x < t * 10 + 20 && y >= 30 && y < 50;
+      int r = square ? 31 : (x / 8) & 31, g = (y * 2 + noise) & 63, b = square ? 0 : 8;
+      frame[y * width + x] = (r << 11) | (g << 5) | b;
+    }
+  }
+  return frame;
+}
+
+static Bytes encodeDeltaFrame(const std::vector<uint16_t> &frame, std::vector<uint16_t> &previous, int width,
+                              int height, int tolerance) {
+  Bytes out(height * deltaRowMaxSize(width));
+  size_t length = 0;
+  for (int y = 0; y < height; y++) {
+    size_t row = encodeDeltaRow(&frame[y * width], &previous[y * width], width, tolerance, out.data() + length);
+    CHECK(row <= deltaRowMaxSize(width));
+    length += row;
+  }
+  out.resize(length);
+  return out;
+}
+
+static bool withinTolerance(uint16_t a, uint16_t b, int tolerance) {
+  return abs((a >> 11) - (b >> 11)) <= tolerance && abs(((a >> 5) & 63) - ((b >> 5) & 63)) <= tolerance &&
+         abs((a & 31) - (b & 31)) <= tolerance;
+}
+
+// Keyframe then deltas: lossless reproduces every frame, lossy stays within
+// the tolerance of each frame and never drifts from the encoder's reference
+static void testDeltaRoundTrip() {
+  for (int width : { 160, 176, 320 }) {
+    int height = width * 3 / 4;
+    for (int tolerance : { 0, 1 }) {
+      std::vector<uint16_t> reference(width * height, 0), decoded(width * height, 0);
+      for (int t = 0; t < 5; t++) {
+        std::vector<uint16_t> frame = frameOf(width, height, t);
+        Bytes encoded = encodeDeltaFrame(frame, reference, width, height, tolerance);
+        CHECK(decodeDeltaFrame(encoded.data(), encoded.size(), decoded.data(), width, height));
+        CHECK(decoded == reference);
+        bool close = true;
+        for (int i = 0; i < width * height; i++) close &= withinTolerance(decoded[i], frame[i], tolerance);
+        CHECK(close);
+        if (t > 0 && tolerance > 0) CHECK(encoded.size() < (size_t)width * height / 4); // Noise absorbed
+      }
+    }
+  }
+}
+
+// Alternating changed/unchanged pixels (4 bytes per pair) stays inside deltaRowMaxSize()
+static void testDeltaWorstCase() {
+  const int width = 320;
+  std::vector<uint16_t> row(width), previous(width, 0);
+  for (int x = 0; x < width; x++) row[x] = x & 1 ? 0 : 0xFFFF;
+  Bytes out(deltaRowMaxSize(width) + 1, 0xCC);
+  size_t length = encodeDeltaRow(row.data(), previous.data(), width, 0, out.data());
+  CHECK(length == width * 2 && length <= deltaRowMaxSize(width));
+  CHECK(out[deltaRowMaxSize(width)] == 0xCC);
+}
+
+static void testDeltaCorrupt() {
+  const int width = 160, height = 120;
+  std::vector<uint16_t> reference(width * height, 0), decoded(width * height);
+  Bytes encoded = encodeDeltaFrame(frameOf(width, height, 3), reference, width, height, 0);
+
+  for (size_t cut = 0; cut < encoded.size(); cut += 7) {
+    std::fill(decoded.begin(), decoded.end(), 0);
+    CHECK(!decodeDeltaFrame(encoded.data(), cut, decoded.data(), width, height));
+  }
+
+  Bytes longer = encoded;
+  longer.push_back(0x80); // One more unchanged pixel than the frame has
+  CHECK(!decodeDeltaFrame(longer.data(), longer.size(), decoded.data(), width, height));
+
+  // Literal run whose words are cut off
+  const uint8_t literal[] = { 0x03, 0x11, 0x22, 0x33 };
+  CHECK(!decodeDeltaFrame(literal, sizeof(literal), decoded.data(), 2, 2));
+  const uint8_t exact[] = { 0x01, 0x11, 0x22, 0x33, 0x44, 0x81 };
+  CHECK(decodeDeltaFrame(exact, sizeof(exact), decoded.data(), 2, 2));
+}
+
+int main() {
+  testCrc();
+  testRoundTrip();
+  testResync();
+  testPayloadCorruption();
+  testTruncated();
+  testOversized();
+  testMaskRoundTrip();
+  testMaskCapacity();
+  testMaskCorrupt();
+  testDeltaRoundTrip();
+  testDeltaWorstCase();
+  testDeltaCorrupt();
+  return testResult("testProtocol");
+}
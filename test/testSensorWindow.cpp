@@ -0,0 +1,134 @@
+// DSP window placement and coordinate mapping from src/sensorWindow.cpp.
+//
+//   g++ -O2 -std=gnu++17 -Isrc -Itest test/testSensorWindow.cpp src/sensorWindow.cpp -o testSensorWindow && ./testSensorWindow
+#include <vector>
+#include "sensorWindow.h"
+#include "check.h"
+
+constexpr FrameSize frame176 = { 176, 144 };
+constexpr FrameSize frame320 = { 320, 240 };
+
+// 176 frame pixels over 800 input pixels: the origin can only move in steps
+// of 11 (50 input pixels), vertically 144 over 600 gives steps of 6
+static void testSnapping() {
+  SensorWindow window;
+  CHECK(placeSensorWindow(window, frame176, { 88, 48 }, 50, 70));
+  CHECK(window.enabled && window.width == 88 && window.height == 48);
+  CHECK(window.x == 11 && window.y == 48);
+  CHECK(window.sensorX == 50 && window.sensorY == 200);
+  CHECK(window.sensorWidth == 400 && window.sensorHeight == 200);
+
+  for (float cx = 0; cx < 176; cx += 0.5f) {
+    CHECK(placeSensorWindow(window, frame176, { 44, 24 }, cx, cx * 0.8f));
+    CHECK(window.x % 11 == 0 && window.y % 6 == 0);
+    CHECK(window.sensorX * 176 == window.x * 800 && window.sensorY * 144 == window.y * 600);
+    // Nearest grid position: the window centre is within half a step
+    if (cx > 22 && cx < 176 - 22) CHECK(window.x + 22 - cx <= 5.5f && cx - (window.x + 22) <= 5.5f);
+  }
+
+  // 320x240: steps of 2
+  CHECK(placeSensorWindow(window, frame320, { 80, 64 }, 100, 61));
+  CHECK(window.x == 60 && window.y == 30);
+  CHECK(window.sensorX == 150 && window.sensorWidth == 200 && window.sensorHeight == 160);
+}
+
+static void testSizesTheRegistersCantExpress() {
+  SensorWindow window;
+  CHECK(!placeSensorWindow(window, frame176, { 90, 48 }, 88, 72)); // Not a multiple of 4
+  CHECK(!window.enabled && window.width == 0 && window.height == 0);
+  CHECK(!placeSensorWindow(window, frame176, { 48, 48 }, 88, 72)); // 48 * 800 / 176 isn't whole
+  CHECK(!placeSensorWindow(window, frame176, { 88, 40 }, 88, 72)); // 40 * 600 / 144 isn't whole
+  CHECK(!placeSensorWindow(window, frame176, { 220, 48 }, 88, 72)); // Wider than the frame
+  CHECK(!placeSensorWindow(window, frame176, { 0, 48 }, 88, 72));
+  CHECK(placeSensorWindow(window, frame176, { 176, 144 }, 0, 0));
+  CHECK(window.x == 0 && window.y == 0 && window.sensorWidth == 800 && window.sensorHeight == 600);
+}
+
+static void testEdgeClamping() {
+  SensorWindow window;
+  CHECK(placeSensorWindow(window, frame176, { 88, 48 }, -100, -100));
+  CHECK(window.x == 0 && window.y == 0);
+  CHECK(placeSensorWindow(window, frame176, { 88, 48 }, 1000, 1000));
+  CHECK(window.x == 88 && window.y == 96);
+  CHECK(window.x + window.width <= 176 && window.y + window.height <= 144);
+
+  // 132 wide leaves 44 to move in, the last grid position is 44 (not past it)
+  CHECK(placeSensorWindow(window, frame176, { 132, 72 }, 175, 143));
+  CHECK(window.x == 44 && window.y == 72);
+  CHECK(window.sensorX + window.sensorWidth <= sensorInputWidth);
+  CHECK(window.sensorY + window.sensorHeight <= sensorInputHeight);
+}
+
+static Blob blobOf(int id, std::vector<Pixel> pixels) {
+  Blob blob = { id, 1 << 30, -1, 1 << 30, -1, 0, 0, 0, 0, 0 };
+  for (const Pixel &p : pixels) {
+    blob.minX = std::min(blob.minX, p.x);
+    blob.maxX = std::max(blob.maxX, p.x);
+    blob.minY = std::min(blob.minY, p.y);
+    blob.maxY = std::max(blob.maxY, p.y);
+    blob.sumX += p.x;
+    blob.sumY += p.y;
+    blob.pixelCount++;
+  }
+  blob.centreX = (float)blob.sumX / blob.pixelCount;
+  blob.centreY = (float)blob.sumY / blob.pixelCount;
+  return blob;
+}
+
+// Blobs labelled in the window come out as if labelled in the whole frame
+static void testWindowToFrame() {
+  SensorWindow window;
+  CHECK(placeSensorWindow(window, frame176, { 88, 48 }, 50, 70));
+  std::vector<Pixel> pixels = { { 3, 4 }, { 4, 4 }, { 5, 6 }, { 10, 2 } };
+  std::vector<Pixel> framePixels;
+  for (const Pixel &p : pixels) framePixels.push_back({ p.x + window.x, p.y + window.y });
+
+  std::vector<Blob> blobs = { blobOf(1, pixels), blobOf(2, { { 0, 0 } }) };
+  windowToFrame(window, blobs);
+  Blob expected = blobOf(1, framePixels);
+  CHECK(blobs[0].minX == expected.minX && blobs[0].maxX == expected.maxX);
+  CHECK(blobs[0].minY == expected.minY && blobs[0].maxY == expected.maxY);
+  CHECK(blobs[0].sumX == expected.sumX && blobs[0].sumY == expected.sumY);
+  CHECK(blobs[0].pixelCount == 4);
+  CHECK(blobs[0].centreX == expected.centreX && blobs[0].centreY == expected.centreY);
+  CHECK(blobs[0].centreX == (float)blobs[0].sumX / blobs[0].pixelCount);
+  CHECK(blobs[1].centreX == window.x && blobs[1].centreY == window.y);
+
+  float x = 12.5f, y = 7.25f;
+  windowToFrame(window, x, y);
+  CHECK(x == 23.5f && y == 55.25f);
+  frameToWindow(window, x, y);
+  CHECK(x == 12.5f && y == 7.25f);
+
+  // Disabled: already frame pixels
+  SensorWindow whole;
+  std::vector<Blob> unchanged = { blobOf(1, pixels) };
+  windowToFrame(whole, unchanged);
+  CHECK(unchanged[0].sumX == blobOf(1, pixels).sumX && unchanged[0].minY == 2);
+}
+
+static void testInsideWindow() {
+  SensorWindow window;
+  CHECK(placeSensorWindow(window, frame176, { 88, 48 }, 50, 70)); // x 11..98, y 48..95
+  CHECK(insideWindow(window, 50, 70, 4));
+  CHECK(insideWindow(window, 15, 52, 4));
+  CHECK(!insideWindow(window, 14.9f, 70, 4));
+  CHECK(!insideWindow(window, 50, 51.9f, 4));
+  CHECK(insideWindow(window, 94, 91, 4));
+  CHECK(!insideWindow(window, 94.1f, 70, 4));
+  CHECK(!insideWindow(window, 50, 91.1f, 4));
+  CHECK(insideWindow(window, 11, 95, 0));
+  CHECK(!insideWindow(window, 54, 71, 30)); // Margin wider than half the window
+
+  SensorWindow whole;
+  CHECK(!insideWindow(whole, 50, 70, 0));
+}
+
+int main() {
+  testSnapping();
+  testSizesTheRegistersCantExpress();
+  testEdgeClamping();
+  testWindowToFrame();
+  testInsideWindow();
+  return testResult("testSensorWindow");
+}
@@ -0,0 +1,113 @@
+// The firmware's capture loop against host/simCamera (see host/simulate.cpp).
+//
+//   g++ -O2 -std=gnu++17 -DTEENSYDUINO -Ilib/ArduCAM -Ihost/shim -Isrc -Ihost -Itest test/testSimulation.cpp src/*.cpp
+//       lib/ArduCAM/ArduCAM.cpp host/shim/shim.cpp host/simCamera.cpp -o testSimulation && ./testSimulation
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include "params.h"
+#include "camera.h"
+#include "replayHardware.h"
+#include "simCamera.h"
+#include "check.h"
+
+void setup();
+void loop();
+extern ArduCAM myCAM;
+
+// A red disc over grey, in the middle of the view or circling it
+static bool moving = false;
+static float discX = 0.5f, discY = 0.5f;
+
+static void prepare(uint64_t time) {
+  float angle = time * 3e-6f; // Radians, about 2 s a turn
+  discX = moving ? 0.5f + 0.3f * sinf(angle) : 0.5f;
+  discY = moving ? 0.5f + 0.3f * cosf(angle) : 0.5f;
+}
+
+static void sample(float x, float y, uint8_t &r, uint8_t &g, uint8_t &b) {
+  float dx = (x - discX) * 800, dy = (y - discY) * 600;
+  if (dx * dx + dy * dy < 30 * 30) r = 200, g = 30, b = 30;
+  else r = 110, g = 120, b = 115;
+}
+
+static bool setNamedParameter(const char *name, float value) {
+  for (int i = 0; i < parameterCount; i++) {
+    if (strcmp(parameters[i].name, name) == 0) return setParameter(parameters[i], value);
+  }
+  return false;
+}
+
+// Runs frames until the firmware has a period measured, false if it never does
+static bool measurePeriod() {
+  for (int frame = 0; frame < 60; frame++) {
+    loop();
+    takeSerialOutput();
+    if (sensorFramePeriod) return true;
+  }
+  return false;
+}
+
+static bool closeToPeriod(uint32_t measured) {
+  return (uint32_t)abs((int)(measured - simFramePeriod())) <= 20;
+}
+
+// Whatever the loop's phase against VSYNC, the measurement is the sensor's period
+static void testFramePeriod() {
+  CHECK(measurePeriod());
+  CHECK(closeToPeriod(sensorFramePeriod));
+  CHECK(simFramePeriod() == 23000);
+
+  for (int divider : { 1, 2, 0 }) {
+    CHECK(setNamedParameter("sensor.clockDivider", divider));
+    CHECK(measurePeriod());
+    CHECK(simFramePeriod() == 23000u * (divider + 1));
+    CHECK(closeToPeriod(sensorFramePeriod));
+  }
+
+  // A manual exposure longer than a frame stretches it
+  CHECK(setNamedParameter("sensor.exposure", 2000));
+  CHECK(setNamedParameter("sensor.autoExposure", 0));
+  CHECK(measurePeriod());
+  CHECK(simFramePeriod() > 23000u * 2);
+  CHECK(closeToPeriod(sensorFramePeriod));
+
+  CHECK(setNamedParameter("sensor.autoExposure", 1));
+  CHECK(measurePeriod());
+  CHECK(sensorFramePeriod == 23000);
+}
+
+// Window moves and resolution switches while tracking, triggered at every
+// phase of the sensor's frame: every write is sent between frames, even with
+// the budget worked out from a wrong period
+static void testNoWritesInsideFrames() {
+  moving = true;
+  CHECK(setNamedParameter("sensorWindow", 1));
+  CHECK(setNamedParameter("trackResolution", 1));
+  uint32_t period = sensorFramePeriod;
+  for (uint32_t assumed : { period, period + 1594, period / 2 + 700 }) {
+    uint32_t writes = simCameraStats.sensorWrites;
+    for (int frame = 0; frame < 150; frame++) {
+      sensorFramePeriod = assumed;
+      loop();
+      takeSerialOutput();
+      advanceClock(simulatedMicros() + frame * 7919 % period);
+    }
+    CHECK(simCameraStats.sensorWrites > writes + 50);
+    CHECK(simCameraStats.writesDuringCapture == 0);
+  }
+  moving = false;
+}
+
+int main() {
+  SimCameraConfig config;
+  config.framePeriod = 23000;
+  initSimCamera(config, { prepare, sample });
+  myCAM.set_transport(&simCameraTransport);
+  setup();
+  takeSerialOutput();
+
+  testFramePeriod();
+  testNoWritesInsideFrames();
+  return testResult("testSimulation");
+}
@@ -0,0 +1,150 @@
+# Host-side decoders in visualOutput/protocol.py, against the wire format in src/protocol.h.
+#
+#   python3 -m unittest discover -s test -p 'test_*.py'
+import os
+import struct
+import sys
+import unittest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'visualOutput'))
+import protocol  # noqa: E402
+
+
+class IdleSerial:
+    # Nothing more arrives, read_message() works through what is buffered
+    in_waiting = 0
+
+    def read(self, n):
+        return b''
+
+
+def read_all(data, reader=None):
+    reader = reader or protocol.MessageReader(IdleSerial())
+    reader.buffer = data
+    messages = []
+    while True:
+        message = reader.read_message(timeout=0)
+        if message is None:
+            return messages
+        messages.append(message)
+
+
+class FramingTest(unittest.TestCase):
+    def test_round_trip(self):
+        payloads = [bytes(range(n)) for n in (0, 1, 40, 255)]
+        data = b''.join(protocol.encode_message(protocol.MSG_BLOBS, p, seq=i, timestamp=100 + i)
+                        for i, p in enumerate(payloads))
+        messages = read_all(data)
+        self.assertEqual([m[4] for m in messages], payloads)
+        self.assertEqual([m[2] for m in messages], [0, 1, 2, 3])
+        self.assertEqual([m[3] for m in messages], [100, 101, 102, 103])
+
+    def test_resync_after_junk_and_damaged_header(self):
+        damaged = bytearray(protocol.encode_message(protocol.MSG_BLOBS, b'x' * 10, seq=2))
+        damaged[7] ^= 0x40  # Length, caught by the header CRC
+        data = (b'\x00\xA5\x13\xA5\x5A\x01' +
+                protocol.encode_message(protocol.MSG_BLOBS, b'first', seq=1) +
+                bytes(damaged) +
+                protocol.encode_message(protocol.MSG_BLOBS, b'\xA5\x5A\xA5', seq=3))
+        messages = read_all(data)
+        self.assertEqual([(m[2], m[4]) for m in messages], [(1, b'first'), (3, b'\xA5\x5A\xA5')])
+
+    def test_payload_crc_drops_only_that_message(self):
+        bad = bytearray(protocol.encode_message(protocol.MSG_BLOBS, b'payload', seq=1))
+        bad[protocol.HEADER_SIZE + 2] ^= 0x01
+        data = bytes(bad) + protocol.encode_message(protocol.MSG_BLOBS, b'next', seq=2)
+        messages = read_all(data)
+        self.assertEqual([(m[2], m[4]) for m in messages], [(2, b'next')])
+
+    def test_losses_count_link_errors_not_sequence_gaps(self):
+        # getSerial.py breaks the delta chain on these, a gap in seq is a message never sent
+        reader = protocol.MessageReader(IdleSerial())
+        read_all(protocol.encode_message(protocol.MSG_BLOBS, b'a', seq=1) +
+                 protocol.encode_message(protocol.MSG_BLOBS, b'b', seq=5), reader)
+        self.assertEqual(reader.losses, 0)
+        bad = bytearray(protocol.encode_message(protocol.MSG_DELTA_FRAME, b'frame', seq=6))
+        bad[-1] ^= 0x01
+        read_all(bytes(bad) + protocol.encode_message(protocol.MSG_BLOBS, b'c', seq=7), reader)
+        self.assertEqual(reader.losses, 1)
+        read_all(b'\x01\x02' + protocol.encode_message(protocol.MSG_BLOBS, b'd', seq=8), reader)
+        self.assertEqual(reader.losses, 2)
+
+    def test_truncated_message_is_not_returned(self):
+        whole = protocol.encode_message(protocol.MSG_BLOBS, b'abcdef', seq=7)
+        for cut in range(len(whole)):
+            self.assertEqual(read_all(whole[:cut]), [])
+
+
+def varint(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        out.append(byte | 0x80 if value else byte)
+        if not value:
+            return bytes(out)
+
+
+def mask_payload(width, height, runs):
+    return struct.pack('<HH', width, height) + b''.join(varint(run) for run in runs)
+
+
+class MaskTest(unittest.TestCase):
+    def test_rle(self):
+        width, height, rows = protocol.decode_mask(protocol.MASK_RLE, mask_payload(4, 2, [3, 2, 3]))
+        self.assertEqual((width, height), (4, 2))
+        self.assertEqual(rows, [[0, 0, 0, 1], [1, 0, 0, 0]])
+
+    def test_rle_long_runs(self):
+        # Multi-byte varints, and an empty first run for a mask starting with 1s
+        decoded = protocol.decode_mask(protocol.MASK_RLE, mask_payload(320, 240, [0, 200, 76600]))
+        self.assertIsNotNone(decoded)
+        self.assertEqual(decoded[2][0][:201], [1] * 200 + [0])
+
+    def test_packed(self):
+        payload = struct.pack('<HH', 4, 2) + bytes([0b10011000])
+        self.assertEqual(protocol.decode_mask(0, payload)[2], [[0, 0, 0, 1], [1, 0, 0, 1]])
+        self.assertIsNone(protocol.decode_mask(0, payload[:4]))
+
+    def test_truncated(self):
+        payload = mask_payload(320, 240, [1000, 200, 75600])
+        for cut in range(len(payload)):
+            self.assertIsNone(protocol.decode_mask(protocol.MASK_RLE, payload[:cut]))
+
+    def test_runs_past_the_mask(self):
+        self.assertIsNone(protocol.decode_mask(protocol.MASK_RLE, mask_payload(4, 2, [3, 2, 4])))
+        self.assertIsNone(protocol.decode_mask(protocol.MASK_RLE, mask_payload(4, 2, [8, 1])))
+        self.assertIsNone(protocol.decode_mask(protocol.MASK_RLE, mask_payload(4, 2, [3, 2, 3]) + b'\xff' * 6))
+
+
+class DeltaFrameTest(unittest.TestCase):
+    # 2x2 frame: literal run of 2, unchanged run of 1, literal run of 1
+    PAYLOAD = (struct.pack('<HH', 2, 2) + bytes([0x01]) + struct.pack('<2H', 0xF800, 0x07E0) +
+               bytes([0x80, 0x00]) + struct.pack('<H', 0x001F))
+
+    def test_keyframe_and_delta(self):
+        frame = [0] * 4
+        self.assertEqual(protocol.decode_delta_frame(self.PAYLOAD, frame), (2, 2))
+        self.assertEqual(frame, [0xF800, 0x07E0, 0, 0x001F])
+        # Same payload again XORs back to zero
+        protocol.decode_delta_frame(self.PAYLOAD, frame)
+        self.assertEqual(frame, [0, 0, 0, 0])
+
+    def test_long_unchanged_run(self):
+        payload = struct.pack('<HH', 160, 1) + bytes([0xFF, 0x80 | 31])  # 128 + 32
+        frame = [0x1234] * 160
+        self.assertEqual(protocol.decode_delta_frame(payload, frame), (160, 1))
+        self.assertEqual(frame, [0x1234] * 160)
+
+    def test_truncated(self):
+        for cut in range(4, len(self.PAYLOAD)):
+            self.assertIsNone(protocol.decode_delta_frame(self.PAYLOAD[:cut], [0] * 4))
+
+    def test_runs_past_the_frame(self):
+        self.assertIsNone(protocol.decode_delta_frame(self.PAYLOAD + bytes([0x80]), [0] * 4))
+        self.assertIsNone(protocol.decode_delta_frame(struct.pack('<HH', 2, 2) + bytes([0x84]), [0] * 4))
+        self.assertIsNone(protocol.decode_delta_frame(self.PAYLOAD, [0] * 6))  # Wrong frame size
+
+
+if __name__ == '__main__':
+    unittest.main()
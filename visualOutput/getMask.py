@@ -1,6 +1,7 @@
 import serial
 import pygame
 import sys
+from protocol import MessageReader, MSG_MASK, decode_mask
 
 
 SERIAL_PORT = 'COM3'
@@ -21,9 +22,7 @@ def main():
         sys.exit(1)
 
     print(f"Listening on {SERIAL_PORT} at {BAUD_RATE} baud...")
-
-    # Buffer to store mask
-    mask_lines = []
+    reader = MessageReader(ser)
 
     running = True
     while running:
@@ -35,25 +34,26 @@ def main():
                 running = False
 
         try:
-            line = ser.readline().decode('ascii', errors='ignore').strip()
+            msg_type, flags, seq, timestamp, payload = reader.read_message()
         except Exception as e:
             print(f"Serial read error: {e}")
             continue
 
-        # Check if line length matches the mask width
-        if len(line) == WIDTH and all(c in '01' for c in line): # Check bitstream is 0,1s
-            mask_lines.append(line)
+        # Binary mask message (packed or run-length coded), other message types are ignored
+        if msg_type != MSG_MASK:
+            continue
+        decoded = decode_mask(flags, payload)
+        if decoded is None or decoded[:2] != (WIDTH, HEIGHT):
+            print("Bad mask message, skipping")
+            continue
 
-            # When we get full frame, draw it
-            if len(mask_lines) == HEIGHT:
-                for y, row in enumerate(mask_lines):
-                    for x, c in enumerate(row):
-                        color = (255, 255, 255) if c == '1' else (0, 0, 0)
-                        rect = pygame.Rect(x * PIXEL_SIZE, y * PIXEL_SIZE, PIXEL_SIZE, PIXEL_SIZE)
-                        pygame.draw.rect(screen, color, rect)
+        for y, row in enumerate(decoded[2]):
+            for x, c in enumerate(row):
+                color = (255, 255, 255) if c else (0, 0, 0)
+                rect = pygame.Rect(x * PIXEL_SIZE, y * PIXEL_SIZE, PIXEL_SIZE, PIXEL_SIZE)
+                pygame.draw.rect(screen, color, rect)
 
-                pygame.display.flip()
-                mask_lines = []
+        pygame.display.flip()
 
     ser.close()
     pygame.quit()
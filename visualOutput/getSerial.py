@@ -1,13 +1,14 @@
 
 import serial
 import time
+import struct
 import cv2
 import numpy as np
+from protocol import (MessageReader, MSG_RAW_FRAME, MSG_DELTA_FRAME, MSG_ROI_FRAME, DELTA_KEYFRAME,
+                      ROI_ON_TARGET, decode_delta_frame, decode_roi_frame)
 
 PORT = 'COM3'
 BAUD = 921600 
-START_MARKER = b'\xAA\x55\xAA\x55'
-END_MARKER = b'\x55\xAA\x55\xAA'
 WIDTH = 160
 HEIGHT = 120
 BYTES_PER_PIXEL = 2  # RGB565
@@ -45,31 +46,68 @@ def rgb565_to_rgb888(rgb565_bytes):
 
     return (r, g, b)
 
-def read_frame(ser):
-    print("Waiting for frame...")
-    buffer = b''
-    while True:
-        chunk = ser.read(ser.in_waiting or 1)  # Read what's available
-        if not chunk:
-            continue
-        buffer += chunk
-
-        if START_MARKER in buffer and END_MARKER in buffer:
-            start_index = buffer.find(START_MARKER)
-            end_index = buffer.find(END_MARKER)
-
-            if end_index < start_index:
-                print("Malformed frame (END before START)")
-                buffer = buffer[end_index + len(END_MARKER):]  # Drop garbage
-                continue
+# Compressed stream state, what the firmware thinks we have. Sequence gaps
+# are messages the firmware never queued (a dropped frame doesn't advance its
+# reference), so only data lost on the link breaks the delta chain.
+reference = [0] * (WIDTH * HEIGHT)
+reference_valid = False
+losses_seen = 0
+
+def read_delta_frame(reader, flags, payload):
+    global reference_valid, losses_seen
+    # Something was lost since the last frame, it may have been a delta: wait for the next keyframe
+    if reader.losses != losses_seen:
+        reference_valid = False
+        losses_seen = reader.losses
+
+    if flags & DELTA_KEYFRAME:
+        reference[:] = [0] * (WIDTH * HEIGHT)
+        reference_valid = True
+    elif not reference_valid:
+        return None
+
+    if decode_delta_frame(payload, reference) != (WIDTH, HEIGHT):
+        print("⚠️ Bad compressed frame, waiting for keyframe")
+        reference_valid = False
+        return None
 
-            frame_data = buffer[start_index + len(START_MARKER):end_index] # Trim markers
+    print(f"Compressed frame {len(payload)} bytes ({EXPECTED_SIZE / len(payload):.1f}x)")
+    return [rgb565_to_rgb888(struct.pack('<H', value)) for value in reference]
 
-            # Clean up buffer to remove used data
-            buffer = buffer[end_index + len(END_MARKER):]
+def read_roi_frame(flags, payload):
+    # Window pasted into a black frame at its origin, so the lock can be watched moving
+    roi = decode_roi_frame(payload)
+    if roi is None or roi[:2] != (WIDTH, HEIGHT):
+        print("⚠️ Bad window frame, skipping")
+        return None
+    _, _, x0, y0, width, height, pixels = roi
+
+    frame_rgb888 = [(0, 0, 0)] * (WIDTH * HEIGHT)
+    for y in range(height):
+        for x in range(width):
+            i = (y * width + x) * 2
+            frame_rgb888[(y0 + y) * WIDTH + x0 + x] = rgb565_to_rgb888(pixels[i:i + 2])
+    if not flags & ROI_ON_TARGET:
+        print("No target, window at frame centre")
+    return frame_rgb888
 
+def read_frame(reader):
+    print("Waiting for frame...")
+    while True:
+        msg_type, flags, seq, timestamp, payload = reader.read_message()
+        if msg_type == MSG_DELTA_FRAME:
+            return read_delta_frame(reader, flags, payload)
+        if msg_type == MSG_ROI_FRAME:
+            return read_roi_frame(flags, payload)
+        if msg_type == MSG_RAW_FRAME:
             break
 
+    width, height = struct.unpack('<HH', payload[:4])
+    frame_data = payload[4:]
+    if (width, height) != (WIDTH, HEIGHT):
+        print(f"⚠️ Unexpected frame size {width}x{height}, skipping")
+        return None
+
     if len(frame_data) > EXPECTED_SIZE:
         print(f"⚠️ Trimming extra {len(frame_data) - EXPECTED_SIZE} bytes from frame_data")
         frame_data = frame_data[:EXPECTED_SIZE]
@@ -88,11 +126,13 @@ def read_frame(ser):
 
 
 def main():
+    global reference_valid
     ser = open_serial()
+    reader = MessageReader(ser)
 
     while True:
         try:
-            frame_rgb888 = read_frame(ser)
+            frame_rgb888 = read_frame(reader)
             if frame_rgb888 is None:
                 continue
 
@@ -108,6 +148,8 @@ def main():
             print(f"⚠️ Serial connection lost: {e}")
             ser.close()
             ser = open_serial()  # Reconnect
+            reader = MessageReader(ser)
+            reference_valid = False
 
     cv2.destroyAllWindows()
     ser.close()
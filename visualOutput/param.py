@@ -0,0 +1,126 @@
+import sys
+import time
+import struct
+import serial
+from protocol import (MessageReader, encode_message, decode_param, MSG_GET_PARAM, MSG_SET_PARAM, MSG_PARAM,
+                      MSG_CONFIG_COMMAND, MSG_CONFIG_RESULT, CONFIG_SAVE, CONFIG_ERASE, PARAM_ALL, PARAM_STATUS,
+                      MSG_GET_SENSOR_STATE, MSG_SENSOR_STATE)
+
+# Read or change firmware parameters at runtime
+#   python param.py            list everything
+#   python param.py kpH        show one
+#   python param.py kpH 12.5   set
+#   python param.py save       store current values (and calibration) in EEPROM
+#   python param.py erase      compiled defaults from the next boot
+#   python param.py sensor     OV2640 registers as last written (driver shadow, no I2C reads)
+
+PORT = 'COM3'
+BAUD = 921600
+
+
+def show(param):
+    status = PARAM_STATUS.get(param['status'], param['status'])
+    if param['name']:
+        print(f"{param['id']:3d} {param['name']:24s} {param['value']:10g}  [{param['min']:g}, {param['max']:g}]  {status}")
+    else:
+        print(f"{param['id']:3d} {status}")
+
+
+def read_reply(reader, timeout=2.0):
+    # Other telemetry keeps flowing, skip it until the deadline
+    deadline = time.monotonic() + timeout
+    while True:
+        message = reader.read_message(max(0, deadline - time.monotonic()))
+        if message is None:
+            return None
+        msg_type, flags, seq, timestamp, payload = message
+        if msg_type == MSG_PARAM:
+            return decode_param(payload)
+
+
+def config_command(ser, reader, action):
+    ser.write(encode_message(MSG_CONFIG_COMMAND, bytes([action])))
+    deadline = time.monotonic() + 2.0  # Flash writes take a while
+    while True:
+        message = reader.read_message(max(0, deadline - time.monotonic()))
+        if message is None:
+            print("No reply")
+            return
+        msg_type, flags, seq, timestamp, payload = message
+        if msg_type == MSG_CONFIG_RESULT:
+            action, status, stored = struct.unpack('<BBH', payload[:4])
+            print(("failed" if status else "ok") + (f", {stored} bytes" if action == CONFIG_SAVE else ""))
+            return
+
+
+def sensor_state(ser, reader):
+    ser.write(encode_message(MSG_GET_SENSOR_STATE, b''))
+    deadline = time.monotonic() + 2.0
+    banks = 0
+    while banks < 2:
+        message = reader.read_message(max(0, deadline - time.monotonic()))
+        if message is None:
+            print("No reply")
+            return
+        msg_type, flags, seq, timestamp, payload = message
+        if msg_type != MSG_SENSOR_STATE:
+            continue
+        bank = payload[0]
+        known, values = payload[1:33], payload[33:289]
+        skipped, writes = struct.unpack_from('<II', payload, 289)
+        period = struct.unpack_from('<I', payload, 297)[0] if len(payload) >= 301 else 0
+        print(f"Bank {bank} ({'sensor' if bank else 'DSP'}):")
+        regs = [f"{reg:02x}={values[reg]:02x}" for reg in range(256) if known[reg >> 3] >> (reg & 7) & 1]
+        for i in range(0, len(regs), 12):
+            print("  " + " ".join(regs[i:i + 12]))
+        banks += 1
+    print(f"{writes} bus writes, {skipped} skipped")
+    if period:
+        print(f"Sensor frame period {period} us ({1e6 / period:.1f} fps)")
+
+
+def main():
+    ser = serial.Serial(PORT, BAUD, timeout=0.1)
+    reader = MessageReader(ser)
+
+    if len(sys.argv) == 2 and sys.argv[1] == 'sensor':
+        sensor_state(ser, reader)
+        ser.close()
+        return
+    if len(sys.argv) == 2 and sys.argv[1] in ('save', 'erase'):
+        config_command(ser, reader, CONFIG_SAVE if sys.argv[1] == 'save' else CONFIG_ERASE)
+        ser.close()
+        return
+
+    # Names only exist on the device, fetch the table first
+    ser.write(encode_message(MSG_GET_PARAM, bytes([PARAM_ALL])))
+    table = {}
+    while True:
+        param = read_reply(reader, 0.5)
+        if param is None:
+            break
+        table[param['name']] = param
+
+    if len(sys.argv) == 1:
+        for param in sorted(table.values(), key=lambda p: p['id']):
+            show(param)
+        return
+
+    name = sys.argv[1]
+    if name not in table:
+        print(f"Unknown parameter {name}")
+        return
+    if len(sys.argv) > 2:
+        ser.write(encode_message(MSG_SET_PARAM, struct.pack('<Bf', table[name]['id'], float(sys.argv[2]))))
+    else:
+        ser.write(encode_message(MSG_GET_PARAM, bytes([table[name]['id']])))
+    param = read_reply(reader)
+    if param is None:
+        print("No reply")
+    else:
+        show(param)
+    ser.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,185 @@
+import struct
+import binascii
+import time
+
+# Framing from src/protocol.h: 16 byte header, payload, CRC32 of payload
+MAGIC = b'\xA5\x5A'
+HEADER_SIZE = 16
+TRAILER_SIZE = 4
+
+MSG_RAW_FRAME = 1
+MSG_MASK = 2
+MSG_BLOBS = 3
+MSG_STATS = 4
+MSG_DELTA_FRAME = 5
+MSG_ROI_FRAME = 6
+MSG_GET_PARAM = 16
+MSG_SET_PARAM = 17
+MSG_PARAM = 18
+MSG_CONFIG_COMMAND = 19
+MSG_CONFIG_RESULT = 20
+MSG_GET_SENSOR_STATE = 21
+MSG_SENSOR_STATE = 22
+
+MASK_RLE = 0x01
+DELTA_KEYFRAME = 0x01
+ROI_ON_TARGET = 0x01
+
+PARAM_ALL = 0xFF
+PARAM_STATUS = {0: 'ok', 1: 'unknown id', 2: 'out of range', 3: 'malformed'}
+CONFIG_SAVE = 0
+CONFIG_ERASE = 1
+
+
+def encode_message(msg_type, payload, seq=0, flags=0, timestamp=0):
+    # Host -> device commands use the same framing
+    header = MAGIC + struct.pack('<BBHII', msg_type, flags, seq, len(payload), timestamp)
+    header += struct.pack('<H', binascii.crc32(header) & 0xFFFF)
+    return header + payload + struct.pack('<I', binascii.crc32(payload))
+
+
+class MessageReader:
+    def __init__(self, ser):
+        self.ser = ser
+        self.buffer = b''
+        self.losses = 0  # Link errors: bytes skipped while hunting for a header, CRC failures
+
+    def read_message(self, timeout=None):
+        # Returns (type, flags, seq, timestamp, payload) for the next message with a valid CRC,
+        # or None if timeout (seconds) passes first
+        deadline = None if timeout is None else time.monotonic() + timeout
+        while True:
+            start = self.buffer.find(MAGIC)
+            if start < 0:
+                if len(self.buffer) > 1:
+                    self.losses += 1
+                self.buffer = self.buffer[-1:]  # Keep a possible first magic byte
+            elif start > 0:
+                self.losses += 1
+                self.buffer = self.buffer[start:]
+                continue
+            elif len(self.buffer) - start >= HEADER_SIZE:
+                header = self.buffer[start:start + HEADER_SIZE]
+                msg_type, flags, seq, length, timestamp, header_crc = struct.unpack('<xxBBHIIH', header)
+                if header_crc != (binascii.crc32(header[:14]) & 0xFFFF):
+                    self.losses += 1
+                    self.buffer = self.buffer[start + 1:]  # Magic inside other data, keep hunting
+                    continue
+
+                total = HEADER_SIZE + length + TRAILER_SIZE
+                if len(self.buffer) - start >= total:
+                    payload = self.buffer[start + HEADER_SIZE:start + HEADER_SIZE + length]
+                    crc, = struct.unpack('<I', self.buffer[start + HEADER_SIZE + length:start + total])
+                    self.buffer = self.buffer[start + total:]
+                    if crc == binascii.crc32(payload):
+                        return msg_type, flags, seq, timestamp, payload
+                    self.losses += 1
+                    print("CRC error, message dropped")
+                    continue
+
+            if deadline is not None and time.monotonic() > deadline:
+                return None
+            chunk = self.ser.read(self.ser.in_waiting or 1)  # Read what's available
+            self.buffer += chunk
+
+
+def decode_mask(flags, payload):
+    # Returns (width, height, rows) with rows as lists of 0/1, or None if the
+    # payload is malformed (truncated varint, runs past the mask, short data)
+    if len(payload) < 4:
+        return None
+    width, height = struct.unpack('<HH', payload[:4])
+    data = payload[4:]
+    bits = width * height
+
+    values = []
+    if flags & MASK_RLE:
+        # Alternating runs of 0s and 1s, LEB128 lengths
+        current = 0
+        i = 0
+        while i < len(data):
+            run = 0
+            shift = 0
+            while True:
+                if i >= len(data) or shift > 28:
+                    return None
+                byte = data[i]
+                i += 1
+                run |= (byte & 0x7F) << shift
+                shift += 7
+                if not byte & 0x80:
+                    break
+            if run > bits - len(values):
+                return None
+            values.extend([current] * run)
+            current ^= 1
+    else:
+        if len(data) < (bits + 7) // 8:
+            return None
+        for i in range(bits):
+            values.append((data[i >> 3] >> (i & 7)) & 1)
+
+    if len(values) != bits:
+        return None
+    return width, height, [values[y * width:(y + 1) * width] for y in range(height)]
+
+
+def decode_delta_frame(payload, frame):
+    # MSG_DELTA_FRAME, XORs the runs into frame (list of RGB565 words, zeroed for a keyframe).
+    # Returns (width, height) or None if the payload doesn't cover the frame exactly.
+    width, height = struct.unpack('<HH', payload[:4])
+    pixels = width * height
+    if len(frame) != pixels:
+        return None
+
+    p = 0
+    i = 4
+    while i < len(payload):
+        control = payload[i]
+        i += 1
+        run = (control & 0x7F) + 1
+        if p + run > pixels:
+            return None
+        if control & 0x80:
+            p += run  # Unchanged
+        else:
+            if i + run * 2 > len(payload):
+                return None
+            for value in struct.unpack_from('<%dH' % run, payload, i):
+                frame[p] ^= value
+                p += 1
+            i += run * 2
+    return (width, height) if p == pixels else None
+
+
+def decode_roi_frame(payload):
+    # MSG_ROI_FRAME, returns (frame_width, frame_height, origin_x, origin_y, width, height, pixel bytes)
+    frame_width, frame_height, x, y, width, height = struct.unpack('<6H', payload[:12])
+    pixels = payload[12:]
+    if len(pixels) != width * height * 2:
+        return None
+    return frame_width, frame_height, x, y, width, height, pixels
+
+
+def decode_param(payload):
+    # MSG_PARAM reply
+    param_id, param_type, status, value, minimum, maximum = struct.unpack('<BBB3f', payload[:15])
+    return {'id': param_id, 'type': param_type, 'status': status, 'value': value,
+            'min': minimum, 'max': maximum, 'name': payload[15:].decode('ascii', 'replace')}
+
+
+def decode_frame_record(payload):
+    # MSG_BLOBS, see FrameRecord in src/protocol.h
+    fields = struct.unpack('<6IBBhh8fB', payload[:63])
+    names = ('frame', 'capture_start', 'capture_us', 'readout_us', 'detect_us', 'track_us',
+             'flags', 'blob_count', 'target_x', 'target_y', 'azimuth', 'elevation',
+             'vel_azimuth', 'vel_elevation', 'pan_command', 'tilt_command', 'pan_actual',
+             'tilt_actual', 'listed')
+    record = dict(zip(names, fields))
+
+    blobs = []
+    for i in range(record['listed']):
+        min_x, max_x, min_y, max_y, cx, cy, count = struct.unpack_from('<7H', payload, 63 + i * 14)
+        blobs.append({'bbox': (min_x, max_x, min_y, max_y), 'centre': (cx / 16, cy / 16), 'pixels': count})
+    record['blobs'] = blobs
+    return record